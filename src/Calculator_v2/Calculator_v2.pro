@@ -2,7 +2,7 @@ QT       += core gui
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets printsupport
 
-CONFIG += c++17
+CONFIG += c++20
 
 lessThan(QT_MAJOR_VERSION, 5): QMAKE_CXXFLAGS += -std=c++11
 
@@ -21,7 +21,25 @@ SOURCES += \
     view/mainwindow.cc \
     view/utils.cc \
     controller/controller.cc \
-    model/calculator.cc
+    controller/plotJob.cc \
+    model/calculator.cc \
+    model/program.cc \
+    model/token.cc \
+    model/expressionCache.cc \
+    model/vectorMath.cc \
+    model/threadPool.cc \
+    model/optimizer.cc \
+    model/expressionDag.cc \
+    model/jitProgram.cc \
+    model/fastMath.cc \
+    model/intervalMath.cc \
+    model/dualMath.cc \
+    model/rootFinder.cc \
+    model/quadrature.cc \
+    model/expected.cc \
+    model/expressionParser.cc \
+    model/compiledExpression.cc \
+    model/budget.cc
 
 HEADERS += \
     model/creditModel.h \
@@ -32,7 +50,28 @@ HEADERS += \
     view/mainwindow.h \
 #    view/utils.h \
     controller/controller.h \
-    model/model.h
+    controller/plotJob.h \
+    model/model.h \
+    model/program.h \
+    model/token.h \
+    model/expressionCache.h \
+    model/vectorMath.h \
+    model/threadPool.h \
+    model/optimizer.h \
+    model/expressionDag.h \
+    model/jitProgram.h \
+    model/fastMath.h \
+    model/intervalMath.h \
+    model/dualMath.h \
+    model/rootFinder.h \
+    model/quadrature.h \
+    model/expected.h \
+    model/expressionParser.h \
+    model/compiledExpression.h \
+    model/budget.h
+
+DISTFILES += \
+    model/vectorMathKernels.inc
 
 FORMS += \
     view/graphic/plotgraph.ui \
@@ -2,8 +2,14 @@
 
 namespace s21 {
 
-/// @brief Controller constructor, init model
-Controller::Controller() : model_(CalcModel()), creditModel_(CreditModel()) {}
+/// @brief Controller constructor, init model, graphs stop at kGraphMaxPoints
+/// points or after kGraphMaxTime with a partial result
+Controller::Controller() : model_(CalcModel()), creditModel_(CreditModel()) {
+  Budget budget;
+  budget.maxPoints = kGraphMaxPoints;
+  budget.maxTime = kGraphMaxTime;
+  model_.setBudget(budget);
+}
 
 /// @brief Calculate controller
 /// @param maimWind MainWindow pointer
@@ -12,14 +18,121 @@ void Controller::calculate(MainWindow *maimWind) {
   maimWind->setResultText(model_.getResult());
 }
 
-/// @brief Get calculated graph from model
+/// @brief Read the graph settings from the main window, on the GUI thread
+/// @param maimWind MainWindow pointer
+/// @param plotWidth plot width in pixels, 0 if unknown
+/// @return PlotRequest
+Controller::PlotRequest Controller::getPlotRequest(MainWindow *maimWind,
+                                                   int plotWidth) const {
+  PlotRequest request;
+  request.expression = maimWind->getInputText();
+  request.step = maimWind->getStep();
+  request.xMax = maimWind->getXMax();
+  request.xMin = maimWind->getXMin();
+  request.yMax = maimWind->getYMax();
+  request.yMin = maimWind->getYMin();
+  request.plotWidth = plotWidth;
+  request.derivative = maimWind->isDerivativePlotted();
+  request.criticalPoints = maimWind->isCriticalPointsMarked();
+  return request;
+}
+
+/// @brief Get limits of graph jobs, a PlotJob runs with a copy and its own
+/// token
+/// @return Budget
+Budget Controller::getBudget() const { return model_.getBudget(); }
+
+/// @brief Calculate the graph of a request: f'(x) if checked, step 0 samples
+/// adaptively, steps finer than kSamplesPerPixel points per pixel are
+/// decimated to the plot
+/// @param model CalcModel of the calling thread
+/// @param request graph settings
+void Controller::calculateGraph(CalcModel &model,
+                                const PlotRequest &request) {
+  double range = std::abs(request.xMax - request.xMin);
+  double points = range / request.step;
+  if (request.derivative) {
+    model.graphCalculateDerivative(
+        request.expression,
+        request.step > 0 ? request.step
+                         : range / CalcModel::kAdaptiveMaxPoints,
+        request.xMax, request.xMin, request.yMax, request.yMin);
+  } else if (request.step <= 0) {
+    model.graphCalculateAdaptive(request.expression, request.xMax,
+                                 request.xMin, request.yMax, request.yMin);
+  } else if (request.plotWidth > 0 &&
+             points > request.plotWidth * CalcModel::kSamplesPerPixel) {
+    model.graphCalculatePixels(
+        request.expression, request.xMax, request.xMin, request.yMax,
+        request.yMin, request.plotWidth,
+        static_cast<std::size_t>(std::ceil(points / request.plotWidth)));
+  } else {
+    model.graphCalculate(request.expression, request.step, request.xMax,
+                         request.xMin, request.yMax, request.yMin);
+  }
+}
+
+/// @brief Calculate a preview of the graph of a request: a sample per pixel
+/// column, or kAdaptiveInitialPoints samples if the width is unknown
+/// @param model CalcModel of the calling thread
+/// @param request graph settings
+void Controller::calculateCoarseGraph(CalcModel &model,
+                                      const PlotRequest &request) {
+  std::size_t width = request.plotWidth > 0
+                          ? static_cast<std::size_t>(request.plotWidth)
+                          : CalcModel::kAdaptiveInitialPoints;
+  if (request.derivative) {
+    model.graphCalculateDerivative(
+        request.expression, std::abs(request.xMax - request.xMin) / width,
+        request.xMax, request.xMin, request.yMax, request.yMin);
+  } else {
+    model.graphCalculatePixels(request.expression, request.xMax,
+                               request.xMin, request.yMax, request.yMin,
+                               width, 1);
+  }
+}
+
+/// @brief Calculate roots and extrema of f(x) of a request, on the graph
+/// grid, or on kAdaptiveMaxPoints points for step 0
+/// @param model CalcModel of the calling thread
+/// @param request graph settings
+/// @return bool, false if not marked or if f'(x) is plotted
+bool Controller::calculateCriticalPoints(CalcModel &model,
+                                         const PlotRequest &request) {
+  if (!request.criticalPoints || request.derivative) {
+    return false;
+  }
+  double range = std::abs(request.xMax - request.xMin);
+  model.criticalPointsCalculate(
+      request.expression,
+      request.step > 0 ? request.step
+                       : range / CalcModel::kAdaptiveMaxPoints,
+      request.xMax, request.xMin);
+  return true;
+}
+
+/// @brief Get calculated graph from model on the calling thread, see
+/// calculateGraph()
 /// @param maimWind MainWindow pointer
+/// @param plotWidth plot width in pixels, 0 if unknown
 /// @return std::pair<std::vector<double>, std::vector<double>>
-CalcModel::GraphXY Controller::getGraphFromModel(MainWindow *maimWind) {
-  model_.graphCalculate(maimWind->getInputText(), maimWind->getStep(),
-                        maimWind->getXMax(), maimWind->getXMin(),
-                        maimWind->getYMax(), maimWind->getYMin());
-  return model_.getGraph();
+CalcModel::GraphXY Controller::getGraphFromModel(MainWindow *maimWind,
+                                                 int plotWidth) {
+  calculateGraph(model_, getPlotRequest(maimWind, plotWidth));
+  return model_.takeGraph();
+}
+
+/// @brief Get roots and extrema of the plotted f(x) from model on the
+/// calling thread, see calculateCriticalPoints()
+/// @param maimWind MainWindow pointer
+/// @return std::vector<CriticalPoint>, empty if not marked or if f'(x) is
+/// plotted
+std::vector<CriticalPoint> Controller::getCriticalPointsFromModel(
+    MainWindow *maimWind) {
+  if (!calculateCriticalPoints(model_, getPlotRequest(maimWind))) {
+    return {};
+  }
+  return model_.getCriticalPoints();
 }
 
 /// @brief Calculates the credit
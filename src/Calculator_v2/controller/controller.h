@@ -1,6 +1,9 @@
 #ifndef CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_CONTROLLER_CONTROLLER_H_
 #define CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_CONTROLLER_CONTROLLER_H_
 
+#include <chrono>
+#include <string>
+
 #include "model/creditModel.h"
 #include "model/depositModel.h"
 #include "model/model.h"
@@ -17,6 +20,10 @@ class MainWindow;
 class Controller {
  public:
   using GraphXY = CalcModel::GraphXY;
+  //! Points a graph of the calculator tab may take, see CalcModel::setBudget
+  static constexpr std::size_t kGraphMaxPoints = 10000000;
+  //! Time a graph of the calculator tab may take
+  static constexpr std::chrono::seconds kGraphMaxTime{10};
 
   Controller();
   ~Controller() = default;
@@ -30,8 +37,31 @@ class Controller {
     double overPay;
   };
 
+  //! Graph settings of the main window, read on the GUI thread so that
+  //! another thread can calculate the graph, see PlotJob
+  struct PlotRequest {
+    std::string expression;
+    double step{0};
+    double xMax{0};
+    double xMin{0};
+    double yMax{0};
+    double yMin{0};
+    int plotWidth{0};  //!< pixels, 0 if unknown
+    bool derivative{false};
+    bool criticalPoints{false};
+  };
+
   void calculate(MainWindow *maimWind);
-  CalcModel::GraphXY getGraphFromModel(MainWindow *maimWind);
+  PlotRequest getPlotRequest(MainWindow *maimWind, int plotWidth = 0) const;
+  Budget getBudget() const;
+  static void calculateGraph(CalcModel &model, const PlotRequest &request);
+  static void calculateCoarseGraph(CalcModel &model,
+                                   const PlotRequest &request);
+  static bool calculateCriticalPoints(CalcModel &model,
+                                      const PlotRequest &request);
+  CalcModel::GraphXY getGraphFromModel(MainWindow *maimWind,
+                                       int plotWidth = 0);
+  std::vector<CriticalPoint> getCriticalPointsFromModel(MainWindow *maimWind);
   CreditResult getCreditCalculated(MainWindow *maimWind);
   void depositCalc(MainWindow *mainWind, std::vector<double> &repl,
                    std::vector<double> &withdwl);
@@ -0,0 +1,89 @@
+#include "plotJob.h"
+
+#include <QMetaType>
+#include <exception>
+
+namespace s21 {
+
+/// @brief PlotJob constructor, call start() to run it
+/// @param request graph settings, see Controller::getPlotRequest()
+/// @param budget limits of each stage, the job uses its own token
+/// @param parent QObject parent
+PlotJob::PlotJob(Controller::PlotRequest request, Budget budget,
+                 QObject *parent)
+    : QThread(parent), request_(std::move(request)) {
+  qRegisterMetaType<QVector<double>>("QVector<double>");
+  qRegisterMetaType<QSharedPointer<QCPGraphDataContainer>>(
+      "QSharedPointer<QCPGraphDataContainer>");
+  budget.token = token_;
+  model_.setBudget(budget);
+}
+
+/// @brief PlotJob destructor, cancels and waits for the worker thread
+PlotJob::~PlotJob() {
+  cancel();
+  wait();
+}
+
+/// @brief stop the job between chunks of points, thread-safe
+void PlotJob::cancel() { token_.cancel(); }
+
+/// @brief worker thread: coarse graph, refined graph, roots and extrema
+void PlotJob::run() {
+  try {
+    Controller::calculateCoarseGraph(model_, request_);
+    emitGraph(false);
+    if (token_.isCancelled()) {
+      emit calculated(true);
+      return;
+    }
+    Controller::calculateGraph(model_, request_);
+    bool truncated = model_.getStatus() == JobStatus::kTruncated;
+    emitGraph(true);
+    if (!token_.isCancelled() &&
+        Controller::calculateCriticalPoints(model_, request_)) {
+      truncated = truncated || model_.getStatus() == JobStatus::kTruncated;
+      emitCriticalPoints();
+    }
+    emit calculated(truncated || token_.isCancelled());
+  } catch (const std::exception &e) {
+    emit failed(QString::fromStdString(e.what()));
+  }
+}
+
+/// @brief emit the graph of model_: the points are moved out of the model
+/// and interleaved once, the container is not copied or sorted again
+/// @param refined false for the coarse preview
+void PlotJob::emitGraph(bool refined) {
+  QSharedPointer<QCPGraphDataContainer> data(new QCPGraphDataContainer);
+  {
+    const CalcModel::GraphXY graph = model_.takeGraph();
+    QVector<QCPGraphData> points(static_cast<qsizetype>(graph.first.size()));
+    QCPGraphData *point = points.data();
+    for (std::size_t i = 0; i < graph.first.size(); ++i, ++point) {
+      point->key = graph.first[i];
+      point->value = graph.second[i];
+    }
+    // x ascends in every CalcModel graph, the container shares points
+    data->set(points, true);
+  }
+  emit graphReady(data, refined);
+}
+
+/// @brief emit roots in red and extrema in green
+void PlotJob::emitCriticalPoints() {
+  QVector<double> rootsX, rootsY, extremaX, extremaY;
+  for (const CriticalPoint &point : model_.getCriticalPoints()) {
+    bool root = point.kind == CriticalPoint::Kind::kRoot;
+    (root ? rootsX : extremaX).push_back(point.x);
+    (root ? rootsY : extremaY).push_back(point.y);
+  }
+  if (!rootsX.isEmpty()) {
+    emit pointsReady(rootsX, rootsY, Qt::red);
+  }
+  if (!extremaX.isEmpty()) {
+    emit pointsReady(extremaX, extremaY, Qt::darkGreen);
+  }
+}
+
+}  // namespace s21
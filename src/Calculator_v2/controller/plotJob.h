@@ -0,0 +1,62 @@
+#ifndef CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_CONTROLLER_PLOTJOB_H_
+#define CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_CONTROLLER_PLOTJOB_H_
+
+#include <QColor>
+#include <QSharedPointer>
+#include <QString>
+#include <QThread>
+#include <QVector>
+
+#include "controller/controller.h"
+#include "qcustomplot.h"
+
+namespace s21 {
+
+//! Graph calculation on a worker thread
+/*!
+  run() calculates a coarse graph of a sample per pixel column, then the
+  requested graph, then the roots and extrema, and emits each result as soon
+  as it is ready: receivers on the GUI thread get them through queued
+  connections and stay responsive meanwhile. The job owns its CalcModel,
+  the model of the Controller belongs to the GUI thread. cancel() may be
+  called from any thread, the running stage stops between chunks of points
+  and the remaining stages are skipped, see CalcModel::setBudget().
+  Graphs are handed over as a sorted QCPGraphDataContainer built once from
+  the points moved out of the model: the plot shares it without copying.
+*/
+class PlotJob : public QThread {
+  Q_OBJECT
+
+ public:
+  PlotJob(Controller::PlotRequest request, Budget budget,
+          QObject *parent = nullptr);
+  ~PlotJob();
+
+ public slots:
+  void cancel();
+
+ signals:
+  //! graph points sorted by x, refined is false for the coarse preview
+  void graphReady(QSharedPointer<QCPGraphDataContainer> data, bool refined);
+  //! roots or extrema to mark over the graph
+  void pointsReady(QVector<double> x, QVector<double> y, QColor color);
+  //! all stages are done, truncated if cancelled or out of budget
+  void calculated(bool truncated);
+  //! the expression is invalid, no more signals follow
+  void failed(QString message);
+
+ protected:
+  void run() override;
+
+ private:
+  Controller::PlotRequest request_;
+  CalcModel model_;
+  CancellationToken token_;
+
+  void emitGraph(bool refined);
+  void emitCriticalPoints();
+};
+
+}  // namespace s21
+
+#endif  // CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_CONTROLLER_PLOTJOB_H_
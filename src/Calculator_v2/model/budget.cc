@@ -0,0 +1,94 @@
+#include "budget.h"
+
+namespace s21 {
+
+/******************************************************************************
+ *                                                                            *
+ *                         CancellationToken class                            *
+ *                                                                            *
+ ******************************************************************************/
+
+/// @brief CancellationToken constructor, not cancelled
+CancellationToken::CancellationToken()
+    : cancelled_(std::make_shared<std::atomic<bool>>(false)) {}
+
+/// @brief cancel the jobs of this token and its copies
+void CancellationToken::cancel() const {
+  cancelled_->store(true, std::memory_order_relaxed);
+}
+
+/// @brief clear the flag before the next job
+void CancellationToken::reset() const {
+  cancelled_->store(false, std::memory_order_relaxed);
+}
+
+/// @brief check the flag
+/// @return bool
+bool CancellationToken::isCancelled() const {
+  return cancelled_->load(std::memory_order_relaxed);
+}
+
+/******************************************************************************
+ *                                                                            *
+ *                            BudgetMeter class                               *
+ *                                                                            *
+ ******************************************************************************/
+
+/// @brief start a job, the time budget counts from now
+/// @param budget limits of the job, the token is shared with the caller
+void BudgetMeter::start(const Budget &budget) {
+  budget_ = budget;
+  Budget::Clock::time_point now = Budget::Clock::now();
+  deadline_ = budget.maxTime < Budget::Clock::time_point::max() - now
+                  ? now + budget.maxTime
+                  : Budget::Clock::time_point::max();
+  stopped_.store(false, std::memory_order_relaxed);
+  truncated_.store(false, std::memory_order_relaxed);
+}
+
+/// @brief check the token and the clock before the next chunk of work
+/// @return bool, false if the job must stop
+bool BudgetMeter::proceed() {
+  if (stopped_.load(std::memory_order_relaxed)) {
+    return false;
+  }
+  if (budget_.token.isCancelled() ||
+      (deadline_ != Budget::Clock::time_point::max() &&
+       Budget::Clock::now() >= deadline_)) {
+    stopped_.store(true, std::memory_order_relaxed);
+    truncate();
+    return false;
+  }
+  return true;
+}
+
+/// @brief clamp the number of points of a job that needs all of them, the
+/// job is truncated if they are more than the point budget
+/// @param points points the job asks for
+/// @return std::size_t points the job may evaluate
+std::size_t BudgetMeter::limitPoints(std::size_t points) {
+  if (points > budget_.maxPoints) {
+    truncate();
+    return budget_.maxPoints;
+  }
+  return points;
+}
+
+/// @brief mark the result partial, e.g. when the job stops at the point
+/// budget
+void BudgetMeter::truncate() {
+  truncated_.store(true, std::memory_order_relaxed);
+}
+
+/// @brief get the point budget
+/// @return std::size_t
+std::size_t BudgetMeter::getMaxPoints() const { return budget_.maxPoints; }
+
+/// @brief get the status of the job
+/// @return JobStatus
+JobStatus BudgetMeter::getStatus() const {
+  return truncated_.load(std::memory_order_relaxed) ? JobStatus::kTruncated
+                                                    : JobStatus::kComplete;
+}
+
+}  // namespace s21
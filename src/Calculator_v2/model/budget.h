@@ -0,0 +1,75 @@
+#ifndef CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_BUDGET_H_
+#define CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_BUDGET_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <memory>
+
+namespace s21 {
+
+//! Flag to stop a running job from another thread
+/*!
+  Copies share the flag: keep a copy, hand one to the job through its
+  Budget and call cancel() from any thread. A cancelled token stays
+  cancelled until reset().
+*/
+class CancellationToken {
+ public:
+  CancellationToken();
+
+  void cancel() const;
+  void reset() const;
+  bool isCancelled() const;
+
+ private:
+  std::shared_ptr<std::atomic<bool>> cancelled_;
+};
+
+//! Outcome of a job run under a Budget
+enum class JobStatus {
+  kComplete,
+  kTruncated,  //!< the budget ran out or the job was cancelled, the result
+               //!< is partial
+};
+
+//! Point and time limits of a job, unlimited by default
+struct Budget {
+  using Clock = std::chrono::steady_clock;
+
+  std::size_t maxPoints{std::numeric_limits<std::size_t>::max()};
+  Clock::duration maxTime{Clock::duration::max()};
+  CancellationToken token;
+};
+
+//! Budget of the running job
+/*!
+  start() reads the clock, the job then asks proceed() before each chunk
+  of work and stops at the first false. proceed() is thread-safe, once it
+  returns false it keeps returning false and the status is kTruncated.
+  Jobs cut short by the point budget call truncate() and go on.
+*/
+class BudgetMeter {
+ public:
+  BudgetMeter() = default;
+
+  void start(const Budget &budget);
+  bool proceed();
+  std::size_t limitPoints(std::size_t points);
+  void truncate();
+
+  // GETTERS
+  std::size_t getMaxPoints() const;
+  JobStatus getStatus() const;
+
+ private:
+  Budget budget_;
+  Budget::Clock::time_point deadline_{Budget::Clock::time_point::max()};
+  std::atomic<bool> stopped_{false};
+  std::atomic<bool> truncated_{false};
+};
+
+}  // namespace s21
+
+#endif  // CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_BUDGET_H_
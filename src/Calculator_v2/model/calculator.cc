@@ -2,412 +2,1017 @@
 
 namespace s21 {
 
-/******************************************************************************
- *                                                                            *
- *                               Token class                                  *
- *                                                                            *
- ******************************************************************************/
-
-/// @brief Token class constructor
-/// @param name token name
-/// @param precedence token precedence
-/// @param associativity token associativity
-/// @param type token type
-/// @param function token function
-Token::Token(const std::string &name, Precedence precedence,
-             Associativity associativity, Type type, functionVariant function)
-    : name_(name),
-      type_(type),
-      precedence_(precedence),
-      associativity_(associativity),
-      function_(function) {}
-
-/// @brief public function to make a token number
-/// @param name token name (number)
-/// @param value number
-void Token::makeNumber(std::string name, double value) {
-  Token result(name, kDefault, kNone, kNumber, value);
-  *this = result;
-}
-
-/// @brief public function to change this token to ~ unary minus
-void Token::makeUnaryNegative() {
-  Token result("~", kUnaryOperator, kRight, kUnaryPrefixOperator,
-               std::negate<double>());
-  *this = result;
-}
-
-/// @brief get name from token
-/// @return string
-std::string Token::getName() const { return name_; }
-/// @brief get type from token
-/// @return Type
-Type Token::getType() const { return type_; }
-/// @brief get precedence from token
-/// @return Precedence
-Precedence Token::getPrecedence() const { return precedence_; }
-/// @brief get token associativity
-/// @return Associativity
-Associativity Token::getAssociativity() const { return associativity_; }
-/// @brief get function from token
-/// @return functionVariant
-Token::functionVariant Token::getFunction() { return function_; }
-
 /******************************************************************************
  *                                                                            *
  *                             CalcModel class                                *
  *                                                                            *
  ******************************************************************************/
 
-/// @brief CalcModel class constructor, initialize tokenMap_
-CalcModel::CalcModel() { createTokenMap(tokenMap_); }
-
-/// @brief Initialize the tokenMap_ add some operators and functions
-/// @param tokenMap std::map<std::string, Token>
-void CalcModel::createTokenMap(std::map<std::string, Token> &tokenMap) {
-  using std::initializer_list;
-  using std::pair;
-  using std::string;
-  initializer_list<pair<const string, Token>> initList = {
-      {"x", Token("x", kDefault, kNone, kNumber, nullptr)},
-      {" ", Token("space", kDefault, kNone, kNumber, nullptr)},
-      {"(", Token("(", kDefault, kNone, kOpenBracket, nullptr)},
-      {")", Token(")", kDefault, kNone, kCloseBracket, nullptr)},
-      {"+", Token("+", kLow, kLeft, kBinaryOperator, std::plus<double>())},
-      {"-", Token("-", kLow, kLeft, kBinaryOperator, std::minus<double>())},
-      {"*",
-       Token("*", kMedium, kLeft, kBinaryOperator, std::multiplies<double>())},
-      {"/",
-       Token("/", kMedium, kLeft, kBinaryOperator, std::divides<double>())},
-      {"^", Token("^", kHigh, kRight, kBinaryOperator, powl)},
-      {"mod", Token("mod", kMedium, kLeft, kBinaryOperator, fmodl)},
-      {"cos", Token("cos", kFunction, kRight, kUnaryFunction, cosl)},
-      {"sin", Token("sin", kFunction, kRight, kUnaryFunction, sinl)},
-      {"tan", Token("tan", kFunction, kRight, kUnaryFunction, tanl)},
-      {"acos", Token("acos", kFunction, kRight, kUnaryFunction, acosl)},
-      {"asin", Token("asin", kFunction, kRight, kUnaryFunction, asinl)},
-      {"atan", Token("atan", kFunction, kRight, kUnaryFunction, atanl)},
-      {"ln", Token("ln", kFunction, kRight, kUnaryFunction, logl)},
-      {"log", Token("log", kFunction, kRight, kUnaryFunction, log10l)},
-      {"sqrt", Token("sqrt", kFunction, kRight, kUnaryFunction, sqrtl)},
-      {"!",
-       Token("!", kUnaryOperator, kLeft, kUnaryPostfixOperator, factorial)},
-      {"%", Token("%", kUnaryOperator, kLeft, kUnaryPostfixOperator, percent)}};
-  tokenMap.insert(initList);
-}
-
 /// @brief get result from CalcModel class
 /// @return calculation result (double)
 double CalcModel::getResult() { return resultNum_; }
 
+/// @brief get derivative calculated by modelDifferentiate()
+/// @return double
+double CalcModel::getDerivative() const { return derivative_; }
+
 /// @brief get graph from CalcModel class
 /// @return calculated graph (std::pair<std::vector<double>,
 /// std::vector<double>> )
 CalcModel::GraphXY CalcModel::getGraph() const { return graphValues_; }
 
-/// @brief transform string to lowercase
-/// @param str input string
-/// @return lowercase string
-std::string CalcModel::toLowerCase(std::string str) {
-  std::transform(str.begin(), str.end(), str.begin(), ::tolower);
-  return str;
+/// @brief move the graph out of CalcModel class, O(1), the model keeps an
+/// empty graph
+/// @return calculated graph (std::pair<std::vector<double>,
+/// std::vector<double>> )
+CalcModel::GraphXY CalcModel::takeGraph() {
+  return std::exchange(graphValues_, GraphXY());
+}
+
+/// @brief get roots and extrema found by criticalPointsCalculate()
+/// @return std::vector<CriticalPoint> ascending by x
+std::vector<CriticalPoint> CalcModel::getCriticalPoints() const {
+  return criticalPoints_;
 }
 
-/// @brief read some word from input string
-/// @param input string to parse
-/// @param startIndex
-/// @return found word (string)
-std::string CalcModel::readWord(std::string &input, size_t &startIndex) const {
-  std::regex wordRegex("([a-z]+)");
-  std::sregex_iterator regexIterator =
-      std::sregex_iterator(input.begin() + startIndex, input.end(), wordRegex);
-  std::smatch match = *regexIterator;
-  startIndex += match.length() - 1;
-  return match.str();
+/// @brief get integral calculated by integralCalculate()
+/// @return Integral
+Integral CalcModel::getIntegral() const { return integral_; }
+
+/// @brief get limits of graph, root and integral jobs
+/// @return Budget, its token is shared with the model
+Budget CalcModel::getBudget() const { return budget_; }
+
+/// @brief get status of the last graph, root or integral job
+/// @return JobStatus, kTruncated if the result is partial
+JobStatus CalcModel::getStatus() const { return meter_.getStatus(); }
+
+/// @brief get compiled expressions cache, e.g. to read hit/miss counters
+/// @return const ExpressionCache&
+const ExpressionCache &CalcModel::getCache() const { return cache_; }
+
+/// @brief get optimizer statistics of the last parsed expression, cache hits
+/// keep the statistics of the previous one
+/// @return Optimizer::Report
+Optimizer::Report CalcModel::getOptimizerReport() const { return report_; }
+
+/// @brief set number of threads for graph evaluation
+/// @param threads size_t, 0 means std::thread::hardware_concurrency()
+void CalcModel::setThreadCount(std::size_t threads) {
+  if (threads != threadCount_) {
+    threadCount_ = threads;
+    pool_.reset();
+  }
 }
 
-/// @brief read double frim input string
-/// @param input
-/// @param startIndex
-/// @return found number (string)
-std::string CalcModel::readDouble(std::string &input, size_t &startIndex) {
-  std::regex doubleRegex("\\d+([.]\\d+)?(e([-+])?\\d+)?");
-  std::sregex_iterator regexIterator = std::sregex_iterator(
-      input.begin() + startIndex, input.end(), doubleRegex);
-  std::smatch match = *regexIterator;
-  startIndex += match.length() - 1;
-  return match.str();
+/// @brief get number of threads for graph evaluation
+/// @return size_t
+std::size_t CalcModel::getThreadCount() const {
+  if (threadCount_ != 0) {
+    return threadCount_;
+  }
+  return std::max(1u, std::thread::hardware_concurrency());
 }
 
-/// @brief clear all containers (input_, output_, stack_, result_)
-void CalcModel::clearAll() {
-  while (!input_.empty()) {
-    input_.pop();
+/// @brief get thread pool, started on first use
+/// @return ThreadPool&
+ThreadPool &CalcModel::getPool() {
+  if (!pool_) {
+    pool_ = std::make_unique<ThreadPool>(getThreadCount());
   }
-  while (!output_.empty()) {
-    output_.pop();
+  return *pool_;
+}
+
+/// @brief enable native code for graph evaluation, falls back to the
+/// interpreter where JitProgram is not supported
+/// @param enabled bool
+void CalcModel::setJitEnabled(bool enabled) {
+  jitEnabled_ = enabled;
+  if (!enabled) {
+    jit_.reset();
+    jitSource_.reset();
   }
-  while (!stack_.empty()) {
-    stack_.pop();
+}
+
+/// @brief check if native code is used for graph evaluation
+/// @return bool
+bool CalcModel::isJitEnabled() const { return jitEnabled_; }
+
+/// @brief enable fast math: approximate sin and cos and reassociate
+/// arithmetic for speed, see Optimizer::relaxPrecision() and FastMath for the
+/// error bounds
+/// @param enabled bool
+void CalcModel::setFastMathEnabled(bool enabled) { fastMath_ = enabled; }
+
+/// @brief check if expressions are compiled in fast math mode
+/// @return bool
+bool CalcModel::isFastMathEnabled() const { return fastMath_; }
+
+/// @brief enable interval sampling of graphs: x ranges whose values are
+/// bounded outside the y window are not evaluated and the line is broken at
+/// likely poles, see IntervalMath::sample(). Off by default: the bounds and
+/// the bisection cost more than the skipped points save, tan(x) on 10^6
+/// points takes 10 ms plain and 17 ms sampled
+/// @param enabled bool
+void CalcModel::setIntervalSamplingEnabled(bool enabled) {
+  intervalSampling_ = enabled;
+}
+
+/// @brief check if graphs are sampled with interval bounds
+/// @return bool
+bool CalcModel::isIntervalSamplingEnabled() const { return intervalSampling_; }
+
+/// @brief build native code for program_ if enabled and not built yet
+void CalcModel::prepareJit() {
+  if (jitEnabled_ && jitSource_ != program_) {
+    jit_ = std::make_unique<JitProgram>(*program_);
+    jitSource_ = program_;
   }
-  while (!result_.empty()) {
-    result_.pop_back();
+}
+
+/// @brief set max number of cached compiled expressions
+/// @param capacity size_t, 0 disables caching
+void CalcModel::setCacheCapacity(std::size_t capacity) {
+  cache_.setCapacity(capacity);
+}
+
+/// @brief set limits of graph, root and integral jobs, checked between
+/// chunks of work: a job that runs out of points or time, or whose token is
+/// cancelled, keeps what it has computed and ends kTruncated, see getStatus()
+/// @param budget Budget, unlimited by default
+void CalcModel::setBudget(const Budget &budget) { budget_ = budget; }
+
+/// @brief calculate posfix notation
+/// @param x_val double
+/// @param precision scalar type of the evaluation
+/// @return double result
+double CalcModel::postfixNotationCalculate(double x_val, Precision precision) {
+  double result = NAN;
+  evaluatePoints(std::span<const double>(&x_val, 1),
+                 std::span<double>(&result, 1), precision);
+  return result;
+}
+
+/// @brief evaluate program_ point-at-a-time for each x
+/// @param xValues x values
+/// @param yValues results
+/// @param precision scalar type of the evaluation
+void CalcModel::evaluatePoints(std::span<const double> xValues,
+                               std::span<double> yValues,
+                               Precision precision) const {
+  switch (precision) {
+    case Precision::kFloat:
+      evaluatePoints<float>(xValues, yValues);
+      break;
+    case Precision::kDouble:
+      evaluatePoints<double>(xValues, yValues);
+      break;
+    case Precision::kLongDouble:
+      evaluatePoints<long double>(xValues, yValues);
+      break;
   }
 }
 
-/// @brief push token to queue input_
-/// @param token token name
-void CalcModel::pushToken(std::string token) {
-  auto tokenIterator = tokenMap_.find(token);
-  if (tokenIterator == tokenMap_.end()) {
-    throw std::logic_error("Incorrect input: " + token);
+/// @brief evaluate program_ point-at-a-time for each x in T
+/// @param xValues x values
+/// @param yValues results
+template <class T>
+void CalcModel::evaluatePoints(std::span<const double> xValues,
+                               std::span<double> yValues) const {
+  std::vector<T> stack(program_->getScratchSize());
+  for (std::size_t i = 0; i < xValues.size(); ++i) {
+    yValues[i] = static_cast<double>(
+        program_->evaluate(static_cast<T>(xValues[i]), stack.data()));
   }
-  input_.push(tokenIterator->second);
 }
 
-/// @brief subfunction helper, change +- to unary
-/// @param input queue<Token>
-void CalcModel::changeUnaryPlusMinus(std::queue<Token> &input) {
-  if (input.front().getName() == "+" || input.front().getName() == "-") {
-    if (input.front().getName() == "-") {
-      input.front().makeUnaryNegative();
-    } else {
-      input.pop();
-    }
+/// @brief get program_ from cache or parse and compile the expression
+/// @param expression string
+/// @param precision scalar type the program is evaluated in
+void CalcModel::compile(const std::string &expression, Precision precision) {
+  program_ = std::move(tryCompile(expression, precision).value());
+}
+
+/// @brief get a program from cache or parse and compile the expression,
+/// without exceptions, program_ is unchanged
+/// @param expression string
+/// @param precision scalar type the program is evaluated in, long double
+/// programs fold fewer constants, see Optimizer::foldConstants()
+/// @return Expected<ProgramPtr>, errors are not cached
+Expected<ExpressionCache::ProgramPtr> CalcModel::tryCompile(
+    const std::string &expression, Precision precision) {
+  std::string key = ExpressionCache::normalize(expression);
+  // never valid expression prefixes
+  if (precision == Precision::kLongDouble) {
+    key.insert(0, "long ");
+  }
+  if (fastMath_) {
+    key.insert(0, "fast ");
+  }
+  ExpressionCache::ProgramPtr program = cache_.find(key);
+  if (program) {
+    return program;
+  }
+  Expected<Program> compiled = ExpressionParser().tryParse(
+      expression, fastMath_ ? Optimizer::Mode::kFast : Optimizer::Mode::kExact,
+      &report_, precision);
+  if (!compiled) {
+    return compiled.error();
   }
+  program = std::make_shared<const Program>(std::move(compiled.value()));
+  cache_.insert(key, program);
+  return program;
 }
 
-/// @brief parse input string
-/// @param input string
-void CalcModel::parseString(std::string &input) {
-  std::string lowerInput = toLowerCase(input);
+/// @brief compile an expression for evaluation from many threads, the
+/// program is shared with the cache, see CompiledExpression
+/// @param expression string
+/// @return CompiledExpression
+CompiledExpression CalcModel::compileExpression(
+    const std::string &expression) {
+  compile(expression, Precision::kLongDouble);
+  return CompiledExpression(program_);
+}
 
-  for (std::string::size_type i = 0; i < lowerInput.size(); ++i) {
-    if (std::isalpha(lowerInput[i])) {
-      pushToken(readWord(lowerInput, i));
-    } else if (std::isdigit(lowerInput[i])) {
-      Token tokenTemp;
-      std::string digit = readDouble(lowerInput, i);
-      tokenTemp.makeNumber(digit, std::stold(digit));
-      input_.push(tokenTemp);
-    } else {
-      pushToken(std::string(1, lowerInput[i]));
-    }
+/// @brief compileExpression() without exceptions, for validating batches of
+/// expressions
+/// @param expression string
+/// @return Expected<CompiledExpression>, the error views point into
+/// expression
+Expected<CompiledExpression> CalcModel::tryCompileExpression(
+    const std::string &expression) {
+  Expected<ExpressionCache::ProgramPtr> program =
+      tryCompile(expression, Precision::kLongDouble);
+  if (!program) {
+    return program.error();
   }
+  return CompiledExpression(std::move(program.value()));
 }
 
-/// @brief delete spaces, change +- to unary, add * if necessary
-void CalcModel::prepairInput() {
-  changeUnaryPlusMinus(input_);
-  moveFromInputToOutput();
-  for (; !input_.empty() && !output_.empty(); moveFromInputToOutput()) {
-    while (input_.front().getName() == "space") {
-      input_.pop();
-    }
-    if (output_.back().getType() != Type::kNumber &&
-        output_.back().getType() != Type::kCloseBracket &&
-        output_.back().getType() != Type::kUnaryPostfixOperator) {
-      changeUnaryPlusMinus(input_);
+/// @brief main public function to calculate input string
+/// @param expression string
+/// @param x double
+/// @param precision scalar type of the evaluation, long double by default
+void CalcModel::modelCalculate(const std::string &expression, double x,
+                               Precision precision) {
+  compile(expression, precision);
+  resultNum_ = postfixNotationCalculate(x, precision);
+}
+
+/// @brief modelCalculate() without exceptions, resultNum_ is set on success
+/// @param expression string
+/// @param x double
+/// @param precision scalar type of the evaluation, long double by default
+/// @return Expected<double>, the error views point into expression
+Expected<double> CalcModel::tryCalculate(const std::string &expression,
+                                         double x, Precision precision) {
+  Expected<ExpressionCache::ProgramPtr> program =
+      tryCompile(expression, precision);
+  if (!program) {
+    return program.error();
+  }
+  program_ = std::move(program.value());
+  resultNum_ = postfixNotationCalculate(x, precision);
+  return resultNum_;
+}
+
+/// @brief helper function calculate for each x, make pair vectors XY
+/// @param step x1, x2, ... step
+/// @param xMax max x value
+/// @param xMin min x value
+/// @param yMax max y value
+/// @param yMin min y value
+/// @param precision scalar type of the evaluation
+void CalcModel::calculateXY(double step, double xMax, double xMin, double yMax,
+                            double yMin, Precision precision) {
+  graphValues_ =
+      evaluateGrid(makeGrid(step, xMax, xMin), yMax, yMin, precision);
+}
+
+/// @brief make x values from xMin by step, at most the point budget
+/// @param step x1, x2, ... step
+/// @param xMax max x value
+/// @param xMin min x value
+/// @return std::vector<double>
+std::vector<double> CalcModel::makeGrid(double step, double xMax,
+                                        double xMin) {
+  double points = abs(xMax - xMin) / step;
+  std::size_t size = 0;
+  if (points >= 1) {
+    size = points < static_cast<double>(meter_.getMaxPoints())
+               ? static_cast<std::size_t>(points)
+               : std::numeric_limits<std::size_t>::max();
+  }
+  std::vector<double> xValues(meter_.limitPoints(size));
+  double next = xMin;
+  for (double &x : xValues) {
+    x = next;
+    next += step;
+  }
+  return xValues;
+}
+
+/// @brief run task for chunks of points on the thread pool, chunks left
+/// when the budget runs out are skipped
+/// @param size number of points
+/// @param task called with the first point and the size of each chunk
+/// @param chunkSize points per chunk, kChunkSize by default
+/// @return std::size_t points of the leading chunks that ran, size if the
+/// budget did not run out
+std::size_t CalcModel::forEachChunk(
+    std::size_t size,
+    const std::function<void(std::size_t, std::size_t)> &task,
+    std::size_t chunkSize) {
+  std::size_t chunks = (size + chunkSize - 1) / chunkSize;
+  std::vector<char> done(chunks, false);
+  auto chunkTask = [&](std::size_t chunk) {
+    if (!meter_.proceed()) {
+      return;
     }
-    if (kMultAddMatrix_[output_.back().getType()][input_.front().getType()]) {
-      output_.push(tokenMap_.find("*")->second);
+    std::size_t begin = chunk * chunkSize;
+    task(begin, std::min(chunkSize, size - begin));
+    done[chunk] = true;
+  };
+  if (chunks > 1 && getThreadCount() > 1) {
+    getPool().parallelFor(chunks, chunkTask);
+  } else {
+    for (std::size_t chunk = 0; chunk < chunks; ++chunk) {
+      chunkTask(chunk);
     }
   }
-  input_.swap(output_);
+  std::size_t ran = std::find(done.begin(), done.end(), false) - done.begin();
+  return std::min(size, ran * chunkSize);
 }
 
-/// @brief Check a sequence of prepaired tokens
-void CalcModel::checkSequence() {
-  int brkCheck = (input_.front().getType() == Type::kOpenBracket ||
-                  input_.front().getType() == Type::kCloseBracket);
-  prepairInput();
-  moveFromInputToOutput();
-  for (; !input_.empty() && !output_.empty(); moveFromInputToOutput()) {
-    if (!kAdjacencyMatrix_[output_.back().getType()]
-                          [input_.front().getType()]) {
-      throw std::logic_error("Wrong sequence: " + output_.back().getName() +
-                             " " + input_.front().getName());
+/// @brief evaluate and clip graph points, chunks of kChunkSize points run on
+/// the thread pool, the result does not depend on the number of threads
+/// @param xValues ascending x values
+/// @param yMax max y value
+/// @param yMin min y value
+/// @param precision scalar type of the evaluation
+/// @return GraphXY, with breaks at poles, the leading points evaluated
+/// within the budget
+CalcModel::GraphXY CalcModel::evaluateGrid(std::vector<double> xValues,
+                                           double yMax, double yMin,
+                                           Precision precision) {
+  std::vector<double> yValues(xValues.size());
+  std::vector<std::vector<std::size_t>> poles(
+      (xValues.size() + kChunkSize - 1) / kChunkSize);
+  std::size_t done = forEachChunk(xValues.size(), [&](std::size_t begin,
+                                                      std::size_t size) {
+    std::vector<std::size_t> &chunkPoles = poles[begin / kChunkSize];
+    // one x more than y values, so poles between chunks are found too
+    std::size_t xSize = std::min(size + 1, xValues.size() - begin);
+    calculateChunk(std::span<const double>(xValues).subspan(begin, xSize),
+                   std::span<double>(yValues).subspan(begin, size), yMax,
+                   yMin, precision, chunkPoles);
+    for (std::size_t &pole : chunkPoles) {
+      pole += begin;
     }
-    if (input_.front().getType() == Type::kOpenBracket) {
-      brkCheck++;
-    } else if (input_.front().getType() == Type::kCloseBracket) {
-      brkCheck--;
+  });
+  if (done < xValues.size()) {
+    xValues.resize(done);
+    yValues.resize(done);
+    poles.resize(done / kChunkSize);
+    // a pole after the last point was found with the next chunk's first x
+    if (!poles.empty() && !poles.back().empty() &&
+        poles.back().back() + 1 >= done) {
+      poles.back().pop_back();
     }
-    if (output_.back().getName() == "/" and input_.front().getName() == "0") {
-      throw std::logic_error("Division by zero error");
+  }
+  insertBreaks(xValues, yValues, poles);
+  return std::make_pair(std::move(xValues), std::move(yValues));
+}
+
+/// @brief helper function calculate f'(x) for each x, make pair vectors XY
+/// @param step x1, x2, ... step
+/// @param xMax max x value
+/// @param xMin min x value
+/// @param yMax max y value
+/// @param yMin min y value
+void CalcModel::calculateDerivativeXY(double step, double xMax, double xMin,
+                                      double yMax, double yMin) {
+  std::vector<double> xValues = makeGrid(step, xMax, xMin);
+  std::vector<double> yValues(xValues.size());
+  std::vector<double> values(xValues.size());  // f, not plotted
+  std::size_t done = forEachChunk(xValues.size(), [&](std::size_t begin,
+                                                      std::size_t size) {
+    DualMath::evaluate(*program_,
+                       std::span<const double>(xValues).subspan(begin, size),
+                       std::span<double>(values).subspan(begin, size),
+                       std::span<double>(yValues).subspan(begin, size));
+  });
+  xValues.resize(done);
+  yValues.resize(done);
+  // f' = 0 is a point of the graph, f' of linear and constant functions
+  for (double &y : yValues) {
+    if (!std::isfinite(y) || y < yMin || y > yMax) {
+      y = std::numeric_limits<double>::quiet_NaN();
     }
   }
-  input_.swap(output_);
-  if (!kFirstToken_[input_.front().getType()]) {
-    throw std::logic_error("Expression cannot start with: " +
-                           input_.front().getName());
+  graphValues_ = std::make_pair(std::move(xValues), std::move(yValues));
+}
+
+/// @brief helper function find roots and extrema: brackets from f and f' on
+/// the graph grid, refined in parallel chunks of kBracketChunkSize brackets
+/// @param step x1, x2, ... step
+/// @param xMax max x value
+/// @param xMin min x value
+void CalcModel::calculateCriticalPoints(double step, double xMax,
+                                        double xMin) {
+  std::vector<double> xValues = makeGrid(step, xMax, xMin);
+  std::vector<double> yValues(xValues.size());
+  std::vector<double> slopes(xValues.size());
+  std::size_t done = forEachChunk(xValues.size(), [&](std::size_t begin,
+                                                      std::size_t size) {
+    DualMath::evaluate(*program_,
+                       std::span<const double>(xValues).subspan(begin, size),
+                       std::span<double>(yValues).subspan(begin, size),
+                       std::span<double>(slopes).subspan(begin, size));
+  });
+  xValues.resize(done);
+  yValues.resize(done);
+  slopes.resize(done);
+  std::vector<RootFinder::Bracket> brackets =
+      RootFinder::bracket(xValues, yValues, slopes);
+  std::vector<std::optional<CriticalPoint>> points(brackets.size());
+  done = forEachChunk(
+      brackets.size(),
+      [&](std::size_t begin, std::size_t size) {
+        std::vector<Dual> stack(program_->getScratchSize());
+        std::vector<Interval> intervals(program_->getScratchSize());
+        for (std::size_t i = begin; i < begin + size; ++i) {
+          points[i] = RootFinder::refine(*program_, brackets[i], stack.data(),
+                                         intervals.data());
+        }
+      },
+      kBracketChunkSize);
+  criticalPoints_.clear();
+  for (std::size_t i = 0; i < done; ++i) {
+    if (points[i]) {
+      criticalPoints_.push_back(*points[i]);
+    }
   }
-  if (!kLastToken_[input_.back().getType()]) {
-    throw std::logic_error("Expression cannot end with: " +
-                           input_.back().getName());
+  // roots and extrema of one grid interval come in kind order
+  std::stable_sort(criticalPoints_.begin(), criticalPoints_.end(),
+                   [](const CriticalPoint &a, const CriticalPoint &b) {
+                     return a.x < b.x;
+                   });
+}
+
+/// @brief helper function integrate from a to b: segments with the largest
+/// errors are halved in rounds until the error is within tolerance, the
+/// budget is spent or no segment can be refined
+/// @param a lower limit
+/// @param b upper limit
+/// @param tolerance max error relative to the integral of |f|
+/// @param maxEvaluations evaluation budget, at most the point budget
+void CalcModel::calculateIntegral(double a, double b, double tolerance,
+                                  std::size_t maxEvaluations) {
+  bool limited = maxEvaluations > meter_.getMaxPoints();
+  maxEvaluations = std::min(maxEvaluations, meter_.getMaxPoints());
+  double lo = std::min(a, b), hi = std::max(a, b);
+  std::vector<Quadrature::Segment> segments(kIntegralInitialSegments);
+  for (std::size_t i = 0; i < segments.size(); ++i) {
+    segments[i].lo = i == 0 ? lo : segments[i - 1].hi;
+    segments[i].hi = i + 1 == segments.size()
+                         ? hi
+                         : lo + (hi - lo) * (i + 1) / segments.size();
   }
-  if (brkCheck != 0) {
-    throw std::logic_error("Brackets check failed " + std::to_string(brkCheck));
+  Integral integral;
+  if (!integrateSegments(segments)) {
+    integral_ = integral;
+    return;
   }
+  integral.evaluations = segments.size() * Quadrature::kNodes;
+  std::vector<Quadrature::Segment> halves;
+  while (true) {
+    // summed in segment order, the result does not depend on threads
+    double value = 0, error = 0, finiteError = 0, absValue = 0;
+    for (const Quadrature::Segment &segment : segments) {
+      value += segment.value;
+      error += segment.error;
+      absValue += segment.absValue;
+      if (!std::isnan(segment.error)) {
+        finiteError += segment.error;
+      }
+    }
+    double target = tolerance * absValue;
+    integral.value = a <= b ? value : -value;
+    integral.error = error;
+    integral.converged = error <= target;
+    std::size_t budget = maxEvaluations - std::min(maxEvaluations,
+                                                   integral.evaluations);
+    std::vector<std::size_t> splits = Quadrature::select(
+        segments, finiteError - target, budget / (2 * Quadrature::kNodes));
+    if (integral.converged || splits.empty()) {
+      if (!integral.converged && limited &&
+          budget < 2 * Quadrature::kNodes) {
+        meter_.truncate();
+      }
+      break;
+    }
+    halves.resize(2 * splits.size());
+    for (std::size_t i = 0; i < splits.size(); ++i) {
+      const Quadrature::Segment &segment = segments[splits[i]];
+      double middle = segment.lo + (segment.hi - segment.lo) / 2;
+      halves[2 * i].lo = segment.lo;
+      halves[2 * i].hi = halves[2 * i + 1].lo = middle;
+      halves[2 * i + 1].hi = segment.hi;
+    }
+    if (!integrateSegments(halves)) {
+      break;
+    }
+    integral.evaluations += halves.size() * Quadrature::kNodes;
+    for (std::size_t i = 0; i < splits.size(); ++i) {
+      segments[splits[i]] = halves[2 * i];
+      segments.push_back(halves[2 * i + 1]);
+    }
+  }
+  integral_ = integral;
+}
+
+/// @brief apply the quadrature rule to segments, chunks of about kChunkSize
+/// nodes run on the thread pool
+/// @param segments segments, lo and hi are read, the rest is written
+/// @return bool, false if the budget ran out before every segment was done
+bool CalcModel::integrateSegments(std::span<Quadrature::Segment> segments) {
+  return segments.size() == forEachChunk(
+      segments.size(),
+      [&](std::size_t begin, std::size_t size) {
+        std::vector<double> xValues(size * Quadrature::kNodes);
+        std::vector<double> yValues(xValues.size());
+        std::span<const double> ys(yValues);
+        for (std::size_t i = 0; i < size; ++i) {
+          Quadrature::nodes(segments[begin + i].lo, segments[begin + i].hi,
+                            std::span<double>(xValues).subspan(
+                                i * Quadrature::kNodes, Quadrature::kNodes));
+        }
+        evaluateGraphPoints(xValues, yValues, Precision::kDouble);
+        for (std::size_t i = 0; i < size; ++i) {
+          segments[begin + i] = Quadrature::rule(
+              segments[begin + i].lo, segments[begin + i].hi,
+              ys.subspan(i * Quadrature::kNodes, Quadrature::kNodes));
+        }
+      },
+      kChunkSize / Quadrature::kNodes);
 }
 
-/// @brief move from input to output queue
-void CalcModel::moveFromInputToOutput() {
-  if (!input_.empty()) {
-    output_.push(input_.front());
-    input_.pop();
+/// @brief sample the graph densely and keep per pixel column only the first,
+/// min, max and last value of each visible run: the polyline has the same
+/// vertical extent in each column as the dense one, with O(pixels) points
+/// @param xMax max x value
+/// @param xMin min x value
+/// @param yMax max y value
+/// @param yMin min y value
+/// @param width plot width in pixels
+/// @param samplesPerPixel dense samples per pixel column
+/// @param precision scalar type of the evaluation
+void CalcModel::calculatePixels(double xMax, double xMin, double yMax,
+                                double yMin, std::size_t width,
+                                std::size_t samplesPerPixel,
+                                Precision precision) {
+  double lo = std::min(xMin, xMax);
+  double hi = std::max(xMin, xMax);
+  width = std::max<std::size_t>(width, 1);
+  // the point budget thins the columns rather than cutting the range
+  samplesPerPixel = std::max<std::size_t>(samplesPerPixel, 1);
+  if (width * samplesPerPixel > meter_.getMaxPoints()) {
+    meter_.truncate();
+    samplesPerPixel =
+        std::max<std::size_t>(meter_.getMaxPoints() / width, 1);
   }
+  std::size_t points = width * samplesPerPixel;
+  std::vector<double> xValues(lo == hi ? 1 : points);
+  for (std::size_t i = 0; i < xValues.size(); ++i) {
+    xValues[i] = i == 0 ? lo : lo + (hi - lo) * i / (points - 1);
+  }
+  GraphXY dense = evaluateGrid(std::move(xValues), yMax, yMin, precision);
+  graphValues_ = decimate(dense, lo, hi, width);
 }
 
-/// @brief move from input queue to stack
-void CalcModel::moveFromInputToStack() {
-  if (!input_.empty()) {
-    stack_.push(input_.front());
-    input_.pop();
+/// @brief keep the first, min, max and last point of each visible run of a
+/// pixel column, one NaN point where the line breaks
+/// @param graph ascending points
+/// @param xMin left edge of the plot
+/// @param xMax right edge of the plot
+/// @param width plot width in pixels
+/// @return GraphXY
+CalcModel::GraphXY CalcModel::decimate(const GraphXY &graph, double xMin,
+                                       double xMax, std::size_t width) {
+  const std::vector<double> &xs = graph.first;
+  const std::vector<double> &ys = graph.second;
+  GraphXY result;
+  double scale = xMax > xMin ? width / (xMax - xMin) : 0;
+  auto columnOf = [&](double x) {
+    return std::min(static_cast<std::size_t>((x - xMin) * scale), width - 1);
+  };
+  std::size_t first = 0, low = 0, high = 0;
+  bool inRun = false;
+  auto flush = [&](std::size_t last) {
+    if (!inRun) {
+      return;
+    }
+    std::size_t kept[] = {first, low, high, last};
+    std::sort(std::begin(kept), std::end(kept));
+    std::size_t *end = std::unique(std::begin(kept), std::end(kept));
+    for (std::size_t *i = std::begin(kept); i != end; ++i) {
+      result.first.push_back(xs[*i]);
+      result.second.push_back(ys[*i]);
+    }
+    inRun = false;
+  };
+  for (std::size_t i = 0; i < xs.size(); ++i) {
+    if (inRun && columnOf(xs[i]) != columnOf(xs[first])) {
+      flush(i - 1);
+    }
+    if (std::isnan(ys[i])) {
+      flush(i - 1);
+      if (!result.second.empty() && !std::isnan(result.second.back())) {
+        result.first.push_back(xs[i]);
+        result.second.push_back(ys[i]);
+      }
+    } else if (!inRun) {
+      first = low = high = i;
+      inRun = true;
+    } else {
+      low = ys[i] < ys[low] ? i : low;
+      high = ys[i] > ys[high] ? i : high;
+    }
   }
+  flush(xs.size() - 1);
+  return result;
 }
 
-/// @brief move from stack to output queue
-void CalcModel::moveFromStackToOutput() {
-  if (!stack_.empty()) {
-    output_.push(stack_.top());
-    stack_.pop();
+/// @brief break the graph line at poles: insert a NaN point between both
+/// visible sides, the line already breaks where one side is not visible
+/// @param xValues x values
+/// @param yValues clipped y values
+/// @param poles ascending indices i of poles between x[i] and x[i + 1]
+void CalcModel::insertBreaks(std::vector<double> &xValues,
+                             std::vector<double> &yValues,
+                             const std::vector<std::vector<std::size_t>> &poles) {
+  std::vector<std::size_t> breaks;
+  for (const std::vector<std::size_t> &chunkPoles : poles) {
+    for (std::size_t i : chunkPoles) {
+      if (!std::isnan(yValues[i]) && !std::isnan(yValues[i + 1])) {
+        breaks.push_back(i);
+      }
+    }
+  }
+  if (breaks.empty()) {
+    return;
+  }
+  std::vector<double> xs;
+  std::vector<double> ys;
+  xs.reserve(xValues.size() + breaks.size());
+  ys.reserve(xs.capacity());
+  std::size_t begin = 0;
+  for (std::size_t i : breaks) {
+    xs.insert(xs.end(), xValues.begin() + begin, xValues.begin() + i + 1);
+    ys.insert(ys.end(), yValues.begin() + begin, yValues.begin() + i + 1);
+    xs.push_back((xValues[i] + xValues[i + 1]) / 2);
+    ys.push_back(std::numeric_limits<double>::quiet_NaN());
+    begin = i + 1;
   }
+  xs.insert(xs.end(), xValues.begin() + begin, xValues.end());
+  ys.insert(ys.end(), yValues.begin() + begin, yValues.end());
+  xValues = std::move(xs);
+  yValues = std::move(ys);
 }
 
-/// @brief push number to result_ vector
-/// @param function double
-void CalcModel::pushToResult(double function) { result_.push_back(function); }
+/// @brief sample the graph adaptively: start from a uniform grid, then
+/// repeatedly halve the intervals next to points that deviate from the
+/// straight line through their neighbours by more than tolerance, largest
+/// deviations first, until the curve is straight within tolerance or
+/// maxPoints are used. Intervals shorter than 2^-20 of the x range are not
+/// split, the line is broken at poles bounded and confirmed by IntervalMath.
+/// @param xMax max x value
+/// @param xMin min x value
+/// @param yMax max y value
+/// @param yMin min y value
+/// @param maxPoints point budget
+/// @param tolerance max deviation in heights of the y window
+void CalcModel::calculateAdaptive(double xMax, double xMin, double yMax,
+                                  double yMin, std::size_t maxPoints,
+                                  double tolerance) {
+  bool limited = maxPoints > meter_.getMaxPoints();
+  maxPoints = std::min(maxPoints, meter_.getMaxPoints());
+  double lo = std::min(xMin, xMax);
+  double hi = std::max(xMin, xMax);
+  std::size_t points = std::min(kAdaptiveInitialPoints, maxPoints);
+  if (lo == hi) {
+    points = std::min<std::size_t>(points, 1);
+  }
+  std::vector<double> xValues(points);
+  std::vector<double> yValues(xValues.size());
+  for (std::size_t i = 0; i < xValues.size(); ++i) {
+    xValues[i] = i == 0 ? lo : lo + (hi - lo) * i / (points - 1);
+  }
+  evaluateGraphPoints(xValues, yValues, Precision::kDouble);
+  // poles between samples are invisible to the bend test, intervals that
+  // may contain one are split as long as the budget allows
+  std::vector<Interval> stack(program_->getScratchSize());
+  auto mayJump = [&](double x0, double x1) -> char {
+    return IntervalMath::evaluate(*program_, {x0, x1}, stack.data())
+        .discontinuous;
+  };
+  std::vector<char> jumps;
+  for (std::size_t i = 0; i + 1 < xValues.size(); ++i) {
+    jumps.push_back(mayJump(xValues[i], xValues[i + 1]));
+  }
+  double minWidth = (hi - lo) * 0x1p-20;
+  std::vector<double> errors;
+  std::vector<std::size_t> splits;
+  std::vector<double> xMiddles, yMiddles;
+  while (xValues.size() < maxPoints) {
+    measureBends(xValues, yValues, yMax, yMin, errors);
+    splits.clear();
+    for (std::size_t i = 0; i < errors.size(); ++i) {
+      if (jumps[i]) {
+        // after the visible bends of the same size
+        errors[i] = std::max(errors[i], 2 * tolerance);
+      }
+      if (errors[i] > tolerance && xValues[i + 1] - xValues[i] > minWidth) {
+        splits.push_back(i);
+      }
+    }
+    if (splits.empty() || !meter_.proceed()) {
+      break;
+    }
+    std::size_t budget = maxPoints - xValues.size();
+    if (splits.size() > budget) {
+      if (limited) {
+        meter_.truncate();
+      }
+      std::nth_element(splits.begin(), splits.begin() + budget, splits.end(),
+                       [&](std::size_t l, std::size_t r) {
+                         return errors[l] > errors[r];
+                       });
+      splits.resize(budget);
+      std::sort(splits.begin(), splits.end());
+    }
+    xMiddles.resize(splits.size());
+    yMiddles.resize(splits.size());
+    for (std::size_t k = 0; k < splits.size(); ++k) {
+      xMiddles[k] = (xValues[splits[k]] + xValues[splits[k] + 1]) / 2;
+    }
+    evaluateGraphPoints(xMiddles, yMiddles, Precision::kDouble);
+    std::vector<double> xs, ys;
+    std::vector<char> js;
+    xs.reserve(xValues.size() + splits.size());
+    ys.reserve(xs.capacity());
+    js.reserve(xs.capacity());
+    std::size_t begin = 0;
+    for (std::size_t k = 0; k < splits.size(); ++k) {
+      std::size_t i = splits[k];
+      xs.insert(xs.end(), xValues.begin() + begin, xValues.begin() + i + 1);
+      ys.insert(ys.end(), yValues.begin() + begin, yValues.begin() + i + 1);
+      js.insert(js.end(), jumps.begin() + begin, jumps.begin() + i);
+      xs.push_back(xMiddles[k]);
+      ys.push_back(yMiddles[k]);
+      js.push_back(jumps[i] && mayJump(xValues[i], xMiddles[k]));
+      js.push_back(jumps[i] && mayJump(xMiddles[k], xValues[i + 1]));
+      begin = i + 1;
+    }
+    xs.insert(xs.end(), xValues.begin() + begin, xValues.end());
+    ys.insert(ys.end(), yValues.begin() + begin, yValues.end());
+    js.insert(js.end(), jumps.begin() + begin, jumps.end());
+    xValues = std::move(xs);
+    yValues = std::move(ys);
+    jumps = std::move(js);
+  }
+  std::vector<std::vector<std::size_t>> poles(1);
+  std::vector<double> scratch(program_->getScratchSize());
+  for (std::size_t i = 0; i < jumps.size(); ++i) {
+    if (jumps[i] && IntervalMath::isJump(*program_, xValues[i],
+                                         xValues[i + 1], scratch.data())) {
+      poles[0].push_back(i);
+    }
+  }
+  for (double &y : yValues) {
+    if (!std::isnormal(y) || y < yMin || y > yMax) {
+      y = std::numeric_limits<double>::quiet_NaN();
+    }
+  }
+  insertBreaks(xValues, yValues, poles);
+  graphValues_ = std::make_pair(std::move(xValues), std::move(yValues));
+}
 
-/// @brief pop last element from result_ vector
-/// @return double
-double CalcModel::popFromResult() {
-  double temp = result_.back();
-  result_.pop_back();
-  return temp;
-}
-
-/// @brief convert infix input_ queue to postfix queue Dijkstra's algorithm
-void CalcModel::convertInfixToPostfix() {
-  checkSequence();
-  while (!input_.empty()) {
-    switch (input_.front().getType()) {
-      case Type::kNumber:
-      case Type::kUnaryPostfixOperator:
-        moveFromInputToOutput();
-        break;
-      case Type::kUnaryFunction:
-      case Type::kUnaryPrefixOperator:
-      case Type::kOpenBracket:
-        moveFromInputToStack();
-        break;
-      case Type::kBinaryOperator:
-        while (
-            !stack_.empty() && !input_.empty() &&
-            ((input_.front().getAssociativity() == Associativity::kLeft &&
-              input_.front().getPrecedence() <= stack_.top().getPrecedence()) ||
-             (input_.front().getAssociativity() == Associativity::kRight &&
-              input_.front().getPrecedence() < stack_.top().getPrecedence())) &&
-            stack_.top().getType() != Type::kOpenBracket) {
-          moveFromStackToOutput();
-        }
-        moveFromInputToStack();
-        break;
-      case Type::kCloseBracket:
-        while (!stack_.empty() &&
-               stack_.top().getType() != Type::kOpenBracket) {
-          moveFromStackToOutput();
-        }
-        if (!stack_.empty()) {
-          stack_.pop();
-          if (!stack_.empty() &&
-              stack_.top().getType() == Type::kUnaryFunction) {
-            moveFromStackToOutput();
-          }
-        }
-        if (!input_.empty()) {
-          input_.pop();
-        }
-        break;
-      default:
-        break;
+/// @brief measure how far the curve bends away from straight lines: the
+/// distance of each point from the line through its neighbours, with y
+/// clamped to the window and in heights of the window, 1 where the curve
+/// starts or stops being defined
+/// @param xValues ascending x values
+/// @param yValues unclipped y values
+/// @param yMax max y value
+/// @param yMin min y value
+/// @param errors max distance at the ends of each interval between points
+void CalcModel::measureBends(const std::vector<double> &xValues,
+                             const std::vector<double> &yValues, double yMax,
+                             double yMin, std::vector<double> &errors) {
+  errors.assign(xValues.empty() ? 0 : xValues.size() - 1, 0);
+  double height = yMax - yMin;
+  if (!(height > 0)) {
+    return;
+  }
+  auto clamp = [&](double y) { return std::clamp(y, yMin, yMax); };
+  for (std::size_t i = 1; i + 1 < xValues.size(); ++i) {
+    int defined = !std::isnan(yValues[i - 1]) + !std::isnan(yValues[i]) +
+                  !std::isnan(yValues[i + 1]);
+    double error = 0;
+    if (defined == 3) {
+      double t = (xValues[i] - xValues[i - 1]) /
+                 (xValues[i + 1] - xValues[i - 1]);
+      double left = clamp(yValues[i - 1]);
+      double line = left + t * (clamp(yValues[i + 1]) - left);
+      error = std::abs(clamp(yValues[i]) - line) / height;
+    } else if (defined != 0) {
+      error = 1;
     }
+    errors[i - 1] = std::max(errors[i - 1], error);
+    errors[i] = std::max(errors[i], error);
   }
-  while (!stack_.empty()) {
-    moveFromStackToOutput();
+}
+
+/// @brief evaluate program_ for graph points
+/// @param xValues x values
+/// @param yValues results
+/// @param precision scalar type, double runs batch evaluation
+void CalcModel::evaluateGraphPoints(std::span<const double> xValues,
+                                    std::span<double> yValues,
+                                    Precision precision) const {
+  if (precision != Precision::kDouble) {
+    evaluatePoints(xValues, yValues, precision);
+  } else if (jit_) {
+    jit_->evaluate(xValues, yValues);
+  } else {
+    program_->evaluate(xValues, yValues);
   }
 }
 
-/// @brief calculate posfix notation
-/// @param x_val double
-/// @return double result
-double CalcModel::postfixNotationCalculate(double x_val) {
-  input_ = output_;
-  for (; !input_.empty(); input_.pop()) {
-    std::visit(overloaded{[&](double function) { pushToResult(function); },
-                          [&](Token::unaryFunction function) {
-                            pushToResult(function(popFromResult()));
-                          },
-                          [&](Token::binaryFunction function) {
-                            double rArg = popFromResult();
-                            double lArg = popFromResult();
-                            pushToResult(function(lArg, rArg));
-                          },
-                          [&](auto) { pushToResult(x_val); }},
-               input_.front().getFunction());
-  }
-  return popFromResult();
+/// @brief evaluate and clip one chunk of graph points, with interval
+/// sampling only the points that may be visible are evaluated
+/// @param xValues x values, may have one more element than yValues: the
+/// first x of the next chunk
+/// @param yValues y values, NaN if outside [yMin, yMax] or not normal
+/// @param yMax max y value
+/// @param yMin min y value
+/// @param precision scalar type, double runs batch evaluation
+/// @param poles indices i of likely poles between x[i] and x[i + 1]
+void CalcModel::calculateChunk(std::span<const double> xValues,
+                               std::span<double> yValues, double yMax,
+                               double yMin, Precision precision,
+                               std::vector<std::size_t> &poles) {
+  std::size_t size = yValues.size();
+  // bounds are computed in double: they hold for double and long double
+  // evaluation, float rounds x and every step to float
+  if (!intervalSampling_ || precision == Precision::kFloat) {
+    evaluateGraphPoints(xValues.first(size), yValues, precision);
+  } else {
+    IntervalMath::Sampling sampling =
+        IntervalMath::sample(*program_, xValues, yMin, yMax);
+    std::size_t i = 0;
+    while (i < size) {
+      std::size_t end = i;
+      while (end < size && sampling.visible[end] == sampling.visible[i]) {
+        ++end;
+      }
+      if (sampling.visible[i]) {
+        evaluateGraphPoints(xValues.subspan(i, end - i),
+                            yValues.subspan(i, end - i), precision);
+      } else {
+        std::fill(yValues.begin() + i, yValues.begin() + end,
+                  std::numeric_limits<double>::quiet_NaN());
+      }
+      i = end;
+    }
+    poles = std::move(sampling.poles);
+  }
+  for (double &y : yValues) {
+    if (!std::isnormal(y) || y < yMin || y > yMax) {
+      y = std::numeric_limits<double>::quiet_NaN();
+    }
+  }
 }
 
-/// @brief main public function to calculate input string
+/// @brief calculate expression and its derivative, see DualMath
 /// @param expression string
 /// @param x double
-void CalcModel::modelCalculate(const std::string &expression, double x) {
-  clearAll();
-  expression_ = expression;
-  parseString(expression_);
-  convertInfixToPostfix();
-  resultNum_ = postfixNotationCalculate(x);
+void CalcModel::modelDifferentiate(const std::string &expression, double x) {
+  compile(expression);
+  std::vector<Dual> stack(program_->getScratchSize());
+  Dual result = DualMath::evaluate(*program_, x, stack.data());
+  resultNum_ = result.value;
+  derivative_ = result.derivative;
 }
 
-/// @brief helper function calculate for each x, make pair vectors XY
+/// @brief main public function for calculate for each point x
+/// @param expression string expression
 /// @param step x1, x2, ... step
 /// @param xMax max x value
 /// @param xMin min x value
 /// @param yMax max y value
 /// @param yMin min y value
-void CalcModel::calculateXY(double step, double xMax, double xMin, double yMax,
-                            double yMin) {
-  std::vector<double> xValues, yValues;
-  x_ = xMin;
-  int points = abs(xMax - xMin) / step;
-  for (int i = 0; i < points; ++i, x_ += step) {
-    xValues.push_back(x_);
-    double y = postfixNotationCalculate(xValues.back());
-    if (std::isnormal(y) && y >= yMin && y <= yMax) {
-      yValues.push_back(y);
-    } else {
-      yValues.push_back(std::numeric_limits<double>::quiet_NaN());
-    }
-  }
-  graphValues_ = std::make_pair(xValues, yValues);
+/// @param precision scalar type of the evaluation, double by default
+void CalcModel::graphCalculate(const std::string &expression, double step,
+                               double xMax, double xMin, double yMax,
+                               double yMin, Precision precision) {
+  compile(expression, precision);
+  prepareJit();
+  meter_.start(budget_);
+  calculateXY(step, xMax, xMin, yMax, yMin, precision);
 }
 
-/// @brief main public function for calculate for each point x
+/// @brief main public function for adaptive graph sampling, the point count
+/// follows the shape of the curve instead of a fixed step
+/// @param expression string expression
+/// @param xMax max x value
+/// @param xMin min x value
+/// @param yMax max y value
+/// @param yMin min y value
+/// @param maxPoints point budget
+/// @param tolerance max deviation of the drawn line from the curve, in
+/// heights of the y window
+void CalcModel::graphCalculateAdaptive(const std::string &expression,
+                                       double xMax, double xMin, double yMax,
+                                       double yMin, std::size_t maxPoints,
+                                       double tolerance) {
+  compile(expression);
+  prepareJit();
+  meter_.start(budget_);
+  calculateAdaptive(xMax, xMin, yMax, yMin, maxPoints, tolerance);
+}
+
+/// @brief main public function for the graph of the derivative, f'(x) comes
+/// from dual number evaluation, see DualMath
 /// @param expression string expression
 /// @param step x1, x2, ... step
 /// @param xMax max x value
 /// @param xMin min x value
 /// @param yMax max y value
 /// @param yMin min y value
-void CalcModel::graphCalculate(const std::string &expression, double step,
-                               double xMax, double xMin, double yMax,
-                               double yMin) {
-  clearAll();
-  expression_ = expression;
-  parseString(expression_);
-  convertInfixToPostfix();
-  calculateXY(step, xMax, xMin, yMax, yMin);
+void CalcModel::graphCalculateDerivative(const std::string &expression,
+                                         double step, double xMax,
+                                         double xMin, double yMax,
+                                         double yMin) {
+  compile(expression);
+  meter_.start(budget_);
+  calculateDerivativeXY(step, xMax, xMin, yMax, yMin);
+}
+
+/// @brief main public function for roots and extrema over [xMin, xMax]:
+/// sign changes of f and f' on the grid graphCalculate() samples, refined to
+/// double precision, see RootFinder
+/// @param expression string expression
+/// @param step x1, x2, ... step
+/// @param xMax max x value
+/// @param xMin min x value
+void CalcModel::criticalPointsCalculate(const std::string &expression,
+                                        double step, double xMax,
+                                        double xMin) {
+  compile(expression);
+  meter_.start(budget_);
+  calculateCriticalPoints(step, xMax, xMin);
+}
+
+/// @brief main public function for the definite integral from a to b by
+/// adaptive Gauss-Kronrod quadrature, see Quadrature
+/// @param expression string expression
+/// @param a lower limit
+/// @param b upper limit
+/// @param tolerance max error relative to the integral of |f|
+/// @param maxEvaluations evaluation budget, the result is not converged if
+/// it runs out first
+void CalcModel::integralCalculate(const std::string &expression, double a,
+                                  double b, double tolerance,
+                                  std::size_t maxEvaluations) {
+  compile(expression);
+  prepareJit();
+  meter_.start(budget_);
+  calculateIntegral(a, b, tolerance, maxEvaluations);
+}
+
+/// @brief main public function for graphs sized to the plot: samplesPerPixel
+/// points per pixel column, decimated to at most 4 per visible run of a
+/// column
+/// @param expression string expression
+/// @param xMax max x value
+/// @param xMin min x value
+/// @param yMax max y value
+/// @param yMin min y value
+/// @param width plot width in pixels
+/// @param samplesPerPixel dense samples per pixel column
+/// @param precision scalar type of the evaluation, double by default
+void CalcModel::graphCalculatePixels(const std::string &expression,
+                                     double xMax, double xMin, double yMax,
+                                     double yMin, std::size_t width,
+                                     std::size_t samplesPerPixel,
+                                     Precision precision) {
+  compile(expression, precision);
+  prepareJit();
+  meter_.start(budget_);
+  calculatePixels(xMax, xMin, yMax, yMin, width, samplesPerPixel, precision);
 }
 
 }  // namespace s21
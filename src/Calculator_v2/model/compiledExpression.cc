@@ -0,0 +1,118 @@
+#include "compiledExpression.h"
+
+namespace s21 {
+
+/******************************************************************************
+ *                                                                            *
+ *                         CompiledExpression class                           *
+ *                                                                            *
+ ******************************************************************************/
+
+/// @brief parse and compile an expression
+/// @param expression string
+/// @param mode optimizer mode, kFast for fast math, kExact by default
+CompiledExpression::CompiledExpression(std::string_view expression,
+                                       Optimizer::Mode mode)
+    : program_(std::make_shared<const Program>(
+          ExpressionParser().parse(expression, mode, nullptr,
+                                   Precision::kLongDouble))) {}
+
+/// @brief share an already compiled program, e.g. from ExpressionCache
+/// @param program program, not nullptr
+CompiledExpression::CompiledExpression(ExpressionCache::ProgramPtr program)
+    : program_(std::move(program)) {}
+
+/// @brief parse and compile an expression without exceptions
+/// @param expression string
+/// @param mode optimizer mode, kFast for fast math, kExact by default
+/// @return Expected<CompiledExpression>, the error views point into
+/// expression
+Expected<CompiledExpression> CompiledExpression::create(
+    std::string_view expression, Optimizer::Mode mode) {
+  Expected<Program> program = ExpressionParser().tryParse(
+      expression, mode, nullptr, Precision::kLongDouble);
+  if (!program) {
+    return program.error();
+  }
+  return CompiledExpression(
+      std::make_shared<const Program>(std::move(program.value())));
+}
+
+/// @brief get program
+/// @return const Program&
+const Program &CompiledExpression::getProgram() const { return *program_; }
+
+/// @brief get scratch memory of the context, grown on first use
+/// @param scratch context buffer
+/// @param size number of elements
+/// @return T* scratch of at least size elements
+template <class T>
+T *CompiledExpression::getScratch(std::vector<T> &scratch,
+                                  std::size_t size) {
+  if (scratch.size() < size) {
+    scratch.resize(size);
+  }
+  return scratch.data();
+}
+
+/// @brief evaluate for x
+/// @param x x value
+/// @param context scratch memory of the calling thread
+/// @param precision scalar type of the evaluation, long double by default
+/// @return double
+double CompiledExpression::evaluate(double x, Context &context,
+                                    Precision precision) const {
+  std::size_t size = program_->getScratchSize();
+  switch (precision) {
+    case Precision::kFloat:
+      return program_->evaluate(static_cast<float>(x),
+                                getScratch(context.floats_, size));
+    case Precision::kDouble:
+      return program_->evaluate(x, getScratch(context.doubles_, size));
+    case Precision::kLongDouble:
+      break;
+  }
+  return static_cast<double>(program_->evaluate(
+      static_cast<long double>(x), getScratch(context.longDoubles_, size)));
+}
+
+/// @brief evaluate column-wise for each x, in double
+/// @param xs x values
+/// @param ys results, same size as xs
+/// @param context scratch memory of the calling thread
+void CompiledExpression::evaluate(std::span<const double> xs,
+                                  std::span<double> ys,
+                                  Context &context) const {
+  program_->evaluate(
+      xs, ys,
+      getScratch(context.columns_,
+                 program_->getScratchSize() * Program::kBlockSize));
+}
+
+/// @brief evaluate column-wise for each x while the budget lasts, in double
+/// @param xs x values
+/// @param ys results, same size as xs
+/// @param context scratch memory of the calling thread
+/// @param meter started budget of the job, see Program::evaluate
+/// @return std::size_t number of leading ys evaluated
+std::size_t CompiledExpression::evaluate(std::span<const double> xs,
+                                         std::span<double> ys,
+                                         Context &context,
+                                         BudgetMeter &meter) const {
+  return program_->evaluate(
+      xs, ys,
+      getScratch(context.columns_,
+                 program_->getScratchSize() * Program::kBlockSize),
+      meter);
+}
+
+/// @brief evaluate f(x) and f'(x), see DualMath
+/// @param x x value
+/// @param context scratch memory of the calling thread
+/// @return Dual
+Dual CompiledExpression::differentiate(double x, Context &context) const {
+  return DualMath::evaluate(
+      *program_, x, getScratch(context.duals_, program_->getScratchSize()));
+}
+
+}  // namespace s21
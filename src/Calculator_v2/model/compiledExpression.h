@@ -0,0 +1,69 @@
+#ifndef CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_COMPILEDEXPRESSION_H_
+#define CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_COMPILEDEXPRESSION_H_
+
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "dualMath.h"
+#include "expected.h"
+#include "expressionCache.h"
+#include "expressionParser.h"
+
+namespace s21 {
+
+//! Compiled expression that threads can share
+/*!
+  Holds a const Program and nothing else, so every method is const and a
+  CompiledExpression can be evaluated from any number of threads at once
+  without locks. The scratch memory of an evaluation lives in a Context
+  owned by the caller: one per thread, reused across calls, so evaluation
+  does not allocate after the first call. Copies share the program, which
+  folds constants for long double evaluation, the default precision.
+*/
+class CompiledExpression {
+ public:
+  //! Scratch memory of one evaluating thread
+  class Context {
+   public:
+    Context() = default;
+
+   private:
+    friend class CompiledExpression;
+
+    std::vector<float> floats_;
+    std::vector<double> doubles_;
+    std::vector<long double> longDoubles_;
+    std::vector<Dual> duals_;
+    std::vector<double> columns_;  //!< of batch evaluation
+  };
+
+  explicit CompiledExpression(
+      std::string_view expression,
+      Optimizer::Mode mode = Optimizer::Mode::kExact);
+  explicit CompiledExpression(ExpressionCache::ProgramPtr program);
+  static Expected<CompiledExpression> create(
+      std::string_view expression,
+      Optimizer::Mode mode = Optimizer::Mode::kExact);
+
+  double evaluate(double x, Context &context,
+                  Precision precision = Precision::kLongDouble) const;
+  void evaluate(std::span<const double> xs, std::span<double> ys,
+                Context &context) const;
+  std::size_t evaluate(std::span<const double> xs, std::span<double> ys,
+                       Context &context, BudgetMeter &meter) const;
+  Dual differentiate(double x, Context &context) const;
+
+  // GETTERS
+  const Program &getProgram() const;
+
+ private:
+  ExpressionCache::ProgramPtr program_;
+
+  template <class T>
+  static T *getScratch(std::vector<T> &scratch, std::size_t size);
+};
+
+}  // namespace s21
+
+#endif  // CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_COMPILEDEXPRESSION_H_
@@ -16,11 +16,36 @@ void DepositModel::calcDeposit(double amount, int term, double interestRate,
                                bool capitalization,
                                std::vector<double> &replenishs,
                                std::vector<double> &withdrawals) {
+  tryCalcDeposit(amount, term, interestRate, taxRate, paymentPeriod,
+                 capitalization, replenishs, withdrawals)
+      .value();
+}
+/// @brief calcDeposit() without exceptions
+/// @param amount amount of the deposit
+/// @param term term of the deposit
+/// @param interestRate interest rate of the deposit
+/// @param taxRate tax rate of the deposit
+/// @param paymentPeriod payment period in months of the deposit
+/// @param capitalization capitalization of the deposit (bool)
+/// @param replenishs vector of replacements
+/// @param withdrawals vector of withdrawals
+/// @return Expected<double> total amount, the error position is the day of
+/// the withdrawal
+Expected<double> DepositModel::tryCalcDeposit(
+    double amount, int term, double interestRate, double taxRate,
+    int paymentPeriod, bool capitalization, std::vector<double> &replenishs,
+    std::vector<double> &withdrawals) {
   amount_ = amount;
-  interest_ = calcInterestInDays(paymentPeriod, term, capitalization,
-                                 interestRate, replenishs, withdrawals);
+  Expected<double> interest =
+      calcInterestInDays(paymentPeriod, term, capitalization, interestRate,
+                         replenishs, withdrawals);
+  if (!interest) {
+    return interest;
+  }
+  interest_ = interest.value();
   taxAmount_ = calcTaxAmount(taxRate, interest_);
   amountAtTheEnd_ = calcTotalAmount(interest_, taxAmount_, capitalization);
+  return amountAtTheEnd_;
 }
 /// @brief Get the accrued interest
 /// @return double accrued interest
@@ -126,12 +151,11 @@ int DepositModel::getDaysInYear(tm currDate) {
 /// @param annualInterestRate
 /// @param replenishments
 /// @param withdrawals
-/// @return amount of accrued interest
-double DepositModel::calcInterestInDays(int paymentPeriod, int term,
-                                        bool capitalization,
-                                        double annualInterestRate,
-                                        std::vector<double> &replenishments,
-                                        std::vector<double> &withdrawals) {
+/// @return Expected<double> amount of accrued interest
+Expected<double> DepositModel::calcInterestInDays(
+    int paymentPeriod, int term, bool capitalization,
+    double annualInterestRate, std::vector<double> &replenishments,
+    std::vector<double> &withdrawals) {
   double interestSumm = 0, interestPeriod = 0;
   tm *currDate = getCurrentDate();
 
@@ -169,8 +193,8 @@ double DepositModel::calcInterestInDays(int paymentPeriod, int term,
       if (amount_ - withdrawals[day] > 0) {
         amount_ -= withdrawals[day];
       } else {
-        throw std::logic_error(
-            "Withdrawals cannot be more than deposit amount.");
+        return Error{ErrorCode::kWithdrawalExceedsAmount,
+                     static_cast<std::size_t>(day)};
       }
     }
   }
@@ -6,6 +6,8 @@
 #include <stdexcept>
 #include <vector>
 
+#include "expected.h"
+
 namespace s21 {
 
 //! Model class for calculate deposit
@@ -20,6 +22,11 @@ class DepositModel {
                    int paymentPeriod, bool capitalization,
                    std::vector<double> &replenishs,
                    std::vector<double> &withdrawals);
+  Expected<double> tryCalcDeposit(double amount, int term, double interestRate,
+                                  double taxRate, int paymentPeriod,
+                                  bool capitalization,
+                                  std::vector<double> &replenishs,
+                                  std::vector<double> &withdrawals);
   // GETTERS
   double getInterestAmount() const;
   double getTaxAmount() const;
@@ -31,10 +38,11 @@ class DepositModel {
   int getDaysToNewYear(tm currDate);
   int countDays(tm currDate, int term);
   int getDaysInYear(tm currDate);
-  double calcInterestInDays(int paymentPeriod, int term, bool capitalization,
-                            double annualInterestRate,
-                            std::vector<double> &replenishments,
-                            std::vector<double> &withdrawals);
+  Expected<double> calcInterestInDays(int paymentPeriod, int term,
+                                      bool capitalization,
+                                      double annualInterestRate,
+                                      std::vector<double> &replenishments,
+                                      std::vector<double> &withdrawals);
   double calcTaxAmount(double taxRate, double interest);
   double calcTotalAmount(double interest, double taxAmount,
                          bool capitalization);
@@ -0,0 +1,232 @@
+#include "dualMath.h"
+
+#include <vector>
+
+#include "fastMath.h"
+
+namespace s21 {
+
+namespace {
+
+constexpr double kPi = 3.14159265358979323846;
+constexpr double kLn10 = 2.30258509299404568402;
+
+}  // namespace
+
+/// @brief evaluate program and its derivative for x
+/// @param program program
+/// @param x x value
+/// @param stack scratch buffer of at least program.getScratchSize() elements
+/// @return Dual f(x) and f'(x)
+Dual DualMath::evaluate(const Program &program, double x, Dual *stack) {
+  Dual *top = stack;
+  Dual *temporaries = stack + program.getStackDepth();
+  const Dual dx{x, 1};
+  for (const Instruction &instruction : program.getCode()) {
+    switch (instruction.code) {
+      case OpCode::kPushConst:
+        *top++ = {program.getConstant(instruction.operand), 0};
+        break;
+      case OpCode::kPushX:
+        *top++ = dx;
+        break;
+      case OpCode::kStore:
+        temporaries[instruction.operand] = top[-1];
+        break;
+      case OpCode::kLoad:
+        *top++ = temporaries[instruction.operand];
+        break;
+      case OpCode::kAdd:
+      case OpCode::kSub:
+      case OpCode::kMul:
+      case OpCode::kDiv:
+      case OpCode::kPow:
+      case OpCode::kMod:
+        --top;
+        top[-1] = applyBinary(instruction.code, top[-1], top[0]);
+        break;
+      case OpCode::kAddX:
+      case OpCode::kSubX:
+      case OpCode::kMulX:
+      case OpCode::kDivX:
+        top[-1] = applyBinary(Program::getBaseOperation(instruction.code),
+                              top[-1], dx);
+        break;
+      case OpCode::kMulAdd: {
+        top -= 2;
+        Dual a = top[-1], b = top[0], c = top[1];
+        top[-1] = {std::fma(a.value, b.value, c.value),
+                   a.derivative * b.value + a.value * b.derivative +
+                       c.derivative};
+        break;
+      }
+      case OpCode::kMulXAdd: {
+        --top;
+        Dual a = top[-1], c = top[0];
+        top[-1] = {std::fma(a.value, x, c.value),
+                   a.derivative * x + a.value + c.derivative};
+        break;
+      }
+      case OpCode::kSinCos:
+      case OpCode::kCosSin:
+      case OpCode::kFastSinCos:
+      case OpCode::kFastCosSin: {
+        auto [first, second] = Program::getSinCosParts(instruction.code);
+        temporaries[instruction.operand] = applyUnary(second, top[-1]);
+        top[-1] = applyUnary(first, top[-1]);
+        break;
+      }
+      default:
+        top[-1] = applyUnary(instruction.code, top[-1]);
+        break;
+    }
+  }
+  return stack[0];
+}
+
+/// @brief evaluate program and its derivative for each x
+/// @param program program
+/// @param xs x values
+/// @param ys f(x) values, same size as xs
+/// @param dys f'(x) values, same size as xs
+void DualMath::evaluate(const Program &program, std::span<const double> xs,
+                        std::span<double> ys, std::span<double> dys) {
+  std::vector<Dual> stack(program.getScratchSize());
+  for (std::size_t i = 0; i < xs.size(); ++i) {
+    Dual y = evaluate(program, xs[i], stack.data());
+    ys[i] = y.value;
+    dys[i] = y.derivative;
+  }
+}
+
+/// @brief calculate unary operation and its derivative
+/// @param code operation code
+/// @param arg argument
+/// @return Dual
+Dual DualMath::applyUnary(OpCode code, Dual arg) {
+  double a = arg.value;
+  double value = Program::applyUnary(code, a);
+  if (arg.derivative == 0) {
+    // constant in x, even where the derivative of the operation is infinite
+    return {value, 0};
+  }
+  double slope = NAN;
+  switch (code) {
+    case OpCode::kNegate:
+      slope = -1;
+      break;
+    case OpCode::kCos:
+      slope = -std::sin(a);
+      break;
+    case OpCode::kSin:
+      slope = std::cos(a);
+      break;
+    case OpCode::kTan:
+      slope = 1 + value * value;
+      break;
+    case OpCode::kAcos:
+      slope = -1 / std::sqrt(1 - a * a);
+      break;
+    case OpCode::kAsin:
+      slope = 1 / std::sqrt(1 - a * a);
+      break;
+    case OpCode::kAtan:
+      slope = 1 / (1 + a * a);
+      break;
+    case OpCode::kLn:
+      slope = 1 / a;
+      break;
+    case OpCode::kLog:
+      slope = 1 / (a * kLn10);
+      break;
+    case OpCode::kSqrt:
+      slope = 0.5 / value;
+      break;
+    case OpCode::kFactorial:
+      slope = value * digamma(a + 1);
+      break;
+    case OpCode::kPercent:
+      slope = 0.01;
+      break;
+    case OpCode::kFastSin:
+      slope = FastMath::cos(a);
+      break;
+    case OpCode::kFastCos:
+      slope = -FastMath::sin(a);
+      break;
+    default:
+      break;
+  }
+  return {value, slope * arg.derivative};
+}
+
+/// @brief calculate binary operation and its derivative
+/// @param code operation code
+/// @param lArg left argument
+/// @param rArg right argument
+/// @return Dual
+Dual DualMath::applyBinary(OpCode code, Dual lArg, Dual rArg) {
+  double a = lArg.value, b = rArg.value;
+  double da = lArg.derivative, db = rArg.derivative;
+  double value = Program::applyBinary(code, a, b);
+  switch (code) {
+    case OpCode::kAdd:
+      return {value, da + db};
+    case OpCode::kSub:
+      return {value, da - db};
+    case OpCode::kMul:
+      return {value, da * b + a * db};
+    case OpCode::kDiv:
+      return {value, db == 0 ? da / b : (da - value * db) / b};
+    case OpCode::kPow: {
+      // terms of constant arguments are left out: 0 * inf would be NaN
+      double derivative = 0;
+      if (da != 0) {
+        derivative += b * std::pow(a, b - 1) * da;
+      }
+      if (db != 0) {
+        derivative += value * std::log(a) * db;
+      }
+      return {value, derivative};
+    }
+    case OpCode::kMod:
+      return {value, db == 0 ? da : da - std::trunc(a / b) * db};
+    default:
+      return {value, NAN};
+  }
+}
+
+/// @brief digamma function, the derivative of ln(gamma(x))
+/// @param x argument
+/// @return double, NaN at the poles 0, -1, -2, ...
+double DualMath::digamma(double x) {
+  if (std::isnan(x) || (x <= 0 && std::floor(x) == x)) {
+    return NAN;
+  }
+  double result = 0;
+  if (x < 0) {
+    // reflection: digamma(1 - x) - digamma(x) = pi / tan(pi x)
+    result = -kPi / std::tan(kPi * x);
+    x = 1 - x;
+  }
+  // recurrence digamma(x + 1) = digamma(x) + 1 / x up to the range of the
+  // asymptotic series
+  for (; x < 10; x += 1) {
+    result -= 1 / x;
+  }
+  double inverse = 1 / x;
+  double inverse2 = inverse * inverse;
+  double series =
+      inverse2 *
+      (1.0 / 12 -
+       inverse2 *
+           (1.0 / 120 -
+            inverse2 *
+                (1.0 / 252 -
+                 inverse2 *
+                     (1.0 / 240 -
+                      inverse2 * (1.0 / 132 - inverse2 * 691.0 / 32760)))));
+  return result + std::log(x) - 0.5 * inverse - series;
+}
+
+}  // namespace s21
@@ -0,0 +1,39 @@
+#ifndef CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_DUALMATH_H_
+#define CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_DUALMATH_H_
+
+#include <span>
+
+#include "program.h"
+
+namespace s21 {
+
+//! Dual number: value and derivative by x
+struct Dual {
+  double value;
+  double derivative;
+};
+
+//! Forward-mode automatic differentiation of programs
+/*!
+  evaluate() runs a program on dual numbers: every operation computes its
+  value as Program does in double and its derivative by the chain rule, so
+  f(x) and f'(x) come out of one pass, exact up to rounding. Piecewise
+  operations use the derivative of the current piece: mod is a - trunc(a /
+  b) * b, derivatives at the jumps are those of the right piece. ! is
+  gamma(a + 1) with the derivative gamma(a + 1) * digamma(a + 1). Fast math
+  codes keep their approximate values, derivatives use the matching fast
+  approximation.
+*/
+class DualMath {
+ public:
+  static Dual evaluate(const Program &program, double x, Dual *stack);
+  static void evaluate(const Program &program, std::span<const double> xs,
+                       std::span<double> ys, std::span<double> dys);
+  static Dual applyUnary(OpCode code, Dual arg);
+  static Dual applyBinary(OpCode code, Dual lArg, Dual rArg);
+  static double digamma(double x);
+};
+
+}  // namespace s21
+
+#endif  // CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_DUALMATH_H_
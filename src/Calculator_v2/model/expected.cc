@@ -0,0 +1,45 @@
+#include "expected.h"
+
+#include <algorithm>
+#include <cctype>
+
+namespace s21 {
+
+/******************************************************************************
+ *                                                                            *
+ *                               Error class                                  *
+ *                                                                            *
+ ******************************************************************************/
+
+/// @brief build the error message
+/// @return std::string, empty for ErrorCode::kNone
+std::string Error::message() const {
+  switch (code) {
+    case ErrorCode::kNone:
+      break;
+    case ErrorCode::kEmptyExpression:
+      return "Empty expression";
+    case ErrorCode::kIncorrectInput: {
+      std::string name(first);
+      std::transform(name.begin(), name.end(), name.begin(),
+                     [](unsigned char c) { return std::tolower(c); });
+      return "Incorrect input: " + name;
+    }
+    case ErrorCode::kWrongSequence:
+      return "Wrong sequence: " + std::string(first) + " " +
+             std::string(second);
+    case ErrorCode::kDivisionByZero:
+      return "Division by zero error";
+    case ErrorCode::kWrongFirstToken:
+      return "Expression cannot start with: " + std::string(first);
+    case ErrorCode::kWrongLastToken:
+      return "Expression cannot end with: " + std::string(first);
+    case ErrorCode::kUnbalancedBrackets:
+      return "Brackets check failed " + std::to_string(count);
+    case ErrorCode::kWithdrawalExceedsAmount:
+      return "Withdrawals cannot be more than deposit amount.";
+  }
+  return {};
+}
+
+}  // namespace s21
@@ -0,0 +1,78 @@
+#ifndef CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_EXPECTED_H_
+#define CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_EXPECTED_H_
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+
+namespace s21 {
+
+//! Error codes of the exception-free API
+enum class ErrorCode {
+  kNone,
+  kEmptyExpression,
+  kIncorrectInput,
+  kWrongSequence,
+  kDivisionByZero,
+  kWrongFirstToken,
+  kWrongLastToken,
+  kUnbalancedBrackets,
+  kWithdrawalExceedsAmount,
+};
+
+//! Structured error, the message is built only by message()
+/*!
+  Cheap to create and copy: no allocation. first and second view the
+  offending tokens in the parsed expression or in the static TokenTable, so
+  they are valid as long as the expression text is. message() returns the
+  text the throwing API puts in its std::logic_error.
+*/
+struct Error {
+  ErrorCode code{ErrorCode::kNone};
+  //! offset of the offending token in the expression, day of the deposit
+  //! term for kWithdrawalExceedsAmount
+  std::size_t position{0};
+  std::string_view first{};
+  std::string_view second{};
+  int count{0};  //!< unmatched brackets, negative for extra ')'
+
+  std::string message() const;
+};
+
+//! Value or Error, a minimal std::expected
+template <class T>
+class Expected {
+ public:
+  Expected(T value) : result_(std::move(value)) {}
+  Expected(Error error) : result_(std::move(error)) {}
+
+  bool hasValue() const { return result_.index() == 0; }
+  explicit operator bool() const { return hasValue(); }
+
+  /// @brief get value
+  /// @return T&, throws std::logic_error with the error message if there is
+  /// no value
+  T &value() {
+    if (!hasValue()) {
+      throw std::logic_error(error().message());
+    }
+    return std::get<0>(result_);
+  }
+
+  /// @brief get error
+  /// @return const Error&, ErrorCode::kNone if there is a value
+  const Error &error() const {
+    static const Error kNoError;
+    return hasValue() ? kNoError : std::get<1>(result_);
+  }
+
+ private:
+  std::variant<T, Error> result_;
+};
+
+}  // namespace s21
+
+#endif  // CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_EXPECTED_H_
@@ -0,0 +1,93 @@
+#include "expressionCache.h"
+
+namespace s21 {
+
+/// @brief ExpressionCache constructor
+/// @param capacity max number of cached programs, 0 disables the cache
+ExpressionCache::ExpressionCache(std::size_t capacity) : capacity_(capacity) {}
+
+/// @brief normalize expression text to a cache key: letters are lowercased
+/// and runs of spaces are collapsed, neither changes the parsed expression
+/// @param expression input string
+/// @return cache key
+std::string ExpressionCache::normalize(std::string_view expression) {
+  std::string key;
+  key.reserve(expression.size());
+  for (char symbol : expression) {
+    if (symbol == ' ' && !key.empty() && key.back() == ' ') {
+      continue;
+    }
+    key += (symbol >= 'A' && symbol <= 'Z') ? symbol - 'A' + 'a' : symbol;
+  }
+  return key;
+}
+
+/// @brief find program and mark it as most recently used
+/// @param key normalized expression
+/// @return cached program or nullptr
+ExpressionCache::ProgramPtr ExpressionCache::find(const std::string &key) {
+  auto found = index_.find(key);
+  if (found == index_.end()) {
+    ++misses_;
+    return nullptr;
+  }
+  ++hits_;
+  entries_.splice(entries_.begin(), entries_, found->second);
+  return found->second->second;
+}
+
+/// @brief insert program, evict the least recently used ones if needed
+/// @param key normalized expression
+/// @param program compiled program
+void ExpressionCache::insert(const std::string &key, ProgramPtr program) {
+  if (capacity_ == 0) {
+    return;
+  }
+  auto found = index_.find(key);
+  if (found != index_.end()) {
+    found->second->second = std::move(program);
+    entries_.splice(entries_.begin(), entries_, found->second);
+    return;
+  }
+  entries_.emplace_front(key, std::move(program));
+  index_.emplace(key, entries_.begin());
+  evict();
+}
+
+/// @brief remove all programs, reset counters
+void ExpressionCache::clear() {
+  entries_.clear();
+  index_.clear();
+  hits_ = 0;
+  misses_ = 0;
+}
+
+/// @brief set max number of cached programs
+/// @param capacity size_t
+void ExpressionCache::setCapacity(std::size_t capacity) {
+  capacity_ = capacity;
+  evict();
+}
+
+/// @brief drop least recently used programs above capacity
+void ExpressionCache::evict() {
+  while (entries_.size() > capacity_) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+}
+
+/// @brief get max number of cached programs
+/// @return size_t
+std::size_t ExpressionCache::getCapacity() const { return capacity_; }
+/// @brief get number of cached programs
+/// @return size_t
+std::size_t ExpressionCache::getSize() const { return entries_.size(); }
+/// @brief get number of find() hits
+/// @return size_t
+std::size_t ExpressionCache::getHits() const { return hits_; }
+/// @brief get number of find() misses
+/// @return size_t
+std::size_t ExpressionCache::getMisses() const { return misses_; }
+
+}  // namespace s21
@@ -0,0 +1,56 @@
+#ifndef CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_EXPRESSIONCACHE_H_
+#define CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_EXPRESSIONCACHE_H_
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+
+#include "program.h"
+
+namespace s21 {
+
+//! Bounded LRU cache of compiled programs
+/*!
+  Keyed by the normalized expression text (see normalize()). Counts hits and
+  misses of find() so the capacity can be sized from real workloads.
+*/
+class ExpressionCache {
+ public:
+  using ProgramPtr = std::shared_ptr<const Program>;
+  static constexpr std::size_t kDefaultCapacity = 16;
+
+  explicit ExpressionCache(std::size_t capacity = kDefaultCapacity);
+  ~ExpressionCache() = default;
+
+  ProgramPtr find(const std::string &key);
+  void insert(const std::string &key, ProgramPtr program);
+  void clear();
+  void setCapacity(std::size_t capacity);
+
+  static std::string normalize(std::string_view expression);
+
+  // GETTERS
+  std::size_t getCapacity() const;
+  std::size_t getSize() const;
+  std::size_t getHits() const;
+  std::size_t getMisses() const;
+
+ private:
+  using Entry = std::pair<std::string, ProgramPtr>;
+
+  std::size_t capacity_;
+  std::size_t hits_{0};
+  std::size_t misses_{0};
+  std::list<Entry> entries_;  //!< most recently used first
+  std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+
+  void evict();
+};
+
+}  // namespace s21
+
+#endif  // CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_EXPRESSIONCACHE_H_
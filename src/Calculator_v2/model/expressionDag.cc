@@ -0,0 +1,215 @@
+#include "expressionDag.h"
+
+#include <bit>
+#include <utility>
+
+namespace s21 {
+
+namespace {
+
+constexpr std::uint32_t kNoNode = UINT32_MAX;
+
+// partner computed by the same reduction and the fused instruction
+std::pair<OpCode, OpCode> getSinCosPartner(OpCode code) {
+  switch (code) {
+    case OpCode::kSin:
+      return {OpCode::kCos, OpCode::kSinCos};
+    case OpCode::kCos:
+      return {OpCode::kSin, OpCode::kCosSin};
+    case OpCode::kFastSin:
+      return {OpCode::kFastCos, OpCode::kFastSinCos};
+    case OpCode::kFastCos:
+      return {OpCode::kFastSin, OpCode::kFastCosSin};
+    default:
+      return {OpCode::kNop, OpCode::kNop};
+  }
+}
+
+}  // namespace
+
+/// @brief build graph from postfix program
+/// @param program compiled program
+ExpressionDag::ExpressionDag(const Program &program) {
+  std::vector<std::uint32_t> stack;
+  std::vector<std::uint32_t> temporaries(program.getTemporaryCount(), kNoNode);
+  for (const Instruction &instruction : program.getCode()) {
+    switch (instruction.code) {
+      case OpCode::kPushConst:
+        stack.push_back(addNode(OpCode::kPushConst,
+                                program.getConstant(instruction.operand),
+                                kNoNode, kNoNode));
+        break;
+      case OpCode::kPushX:
+        stack.push_back(addNode(OpCode::kPushX, 0.0, kNoNode, kNoNode));
+        break;
+      case OpCode::kStore:
+        temporaries[instruction.operand] = stack.back();
+        break;
+      case OpCode::kLoad:
+        stack.push_back(temporaries[instruction.operand]);
+        break;
+      case OpCode::kAddX:
+      case OpCode::kSubX:
+      case OpCode::kMulX:
+      case OpCode::kDivX:
+        stack.back() = addNode(Program::getBaseOperation(instruction.code),
+                               0.0, stack.back(),
+                               addNode(OpCode::kPushX, 0.0, kNoNode, kNoNode));
+        break;
+      case OpCode::kMulAdd: {
+        std::uint32_t addend = stack.back();
+        stack.pop_back();
+        std::uint32_t factor = stack.back();
+        stack.pop_back();
+        stack.back() =
+            addNode(OpCode::kAdd, 0.0,
+                    addNode(OpCode::kMul, 0.0, stack.back(), factor), addend);
+        break;
+      }
+      case OpCode::kMulXAdd: {
+        std::uint32_t addend = stack.back();
+        stack.pop_back();
+        std::uint32_t x = addNode(OpCode::kPushX, 0.0, kNoNode, kNoNode);
+        stack.back() = addNode(OpCode::kAdd, 0.0,
+                               addNode(OpCode::kMul, 0.0, stack.back(), x),
+                               addend);
+        break;
+      }
+      case OpCode::kSinCos:
+      case OpCode::kCosSin:
+      case OpCode::kFastSinCos:
+      case OpCode::kFastCosSin: {
+        auto [first, second] = Program::getSinCosParts(instruction.code);
+        std::uint32_t arg = stack.back();
+        stack.back() = addNode(first, 0.0, arg, kNoNode);
+        temporaries[instruction.operand] = addNode(second, 0.0, arg, kNoNode);
+        break;
+      }
+      default:
+        if (Program::getArity(instruction.code) == 2) {
+          std::uint32_t rArg = stack.back();
+          stack.pop_back();
+          stack.back() = addNode(instruction.code, 0.0, stack.back(), rArg);
+        } else {
+          stack.back() = addNode(instruction.code, 0.0, stack.back(), kNoNode);
+        }
+    }
+  }
+  root_ = stack.back();
+}
+
+/// @brief find equal node or append a new one
+/// @param code operation code
+/// @param value constant value for kPushConst
+/// @param lArg first argument node
+/// @param rArg second argument node
+/// @return node index
+std::uint32_t ExpressionDag::addNode(OpCode code, double value,
+                                     std::uint32_t lArg, std::uint32_t rArg) {
+  Key key{code, std::bit_cast<std::uint64_t>(value), {lArg, rArg}};
+  if ((code == OpCode::kAdd || code == OpCode::kMul) && lArg > rArg) {
+    std::swap(key.args[0], key.args[1]);
+  }
+  auto [it, inserted] =
+      index_.try_emplace(key, static_cast<std::uint32_t>(nodes_.size()));
+  if (inserted) {
+    nodes_.push_back({code, value, {lArg, rArg}, 0});
+    for (std::uint32_t arg : {lArg, rArg}) {
+      if (arg != kNoNode) {
+        ++nodes_[arg].uses;
+      }
+    }
+  } else if (lArg != kNoNode) {
+    ++deduplicated_;
+  }
+  return it->second;
+}
+
+/// @brief find cos(a) for sin(a) and the other way round, fast or exact
+/// @param index node index
+/// @return partner node index or kNoNode
+std::uint32_t ExpressionDag::findPartner(std::uint32_t index) const {
+  const Node &node = nodes_[index];
+  OpCode partner = getSinCosPartner(node.code).first;
+  if (partner == OpCode::kNop) {
+    return kNoNode;
+  }
+  auto found = index_.find(
+      {partner, std::bit_cast<std::uint64_t>(0.0), {node.args[0], kNoNode}});
+  return found == index_.end() ? kNoNode : found->second;
+}
+
+/// @brief emit postfix program, nodes used more than once are computed once
+/// and kept in temporaries, sin and cos of the same argument are fused
+/// @return program
+Program ExpressionDag::toProgram() {
+  fused_ = 0;
+  Program::Builder builder;
+  std::vector<std::uint32_t> slots(nodes_.size(), kNoNode);
+  std::vector<bool> emitted(nodes_.size(), false);
+  std::uint32_t temporaries = 0;
+  // (node, arguments already emitted)
+  std::vector<std::pair<std::uint32_t, bool>> pending{{root_, false}};
+  while (!pending.empty()) {
+    auto [index, ready] = pending.back();
+    pending.pop_back();
+    const Node &node = nodes_[index];
+    if (slots[index] != kNoNode) {
+      builder.pushOperation(OpCode::kLoad, slots[index]);
+    } else if (node.code == OpCode::kPushConst) {
+      builder.pushConstant(node.value);
+    } else if (node.code == OpCode::kPushX) {
+      builder.pushOperation(OpCode::kPushX);
+    } else if (!ready) {
+      pending.emplace_back(index, true);
+      for (int i = 1; i >= 0; --i) {
+        if (node.args[i] != kNoNode) {
+          pending.emplace_back(node.args[i], false);
+        }
+      }
+    } else {
+      std::uint32_t partner = findPartner(index);
+      if (partner != kNoNode && !emitted[partner]) {
+        // the partner is computed here and loaded where it is used
+        slots[partner] = temporaries++;
+        builder.pushOperation(getSinCosPartner(node.code).second,
+                              slots[partner]);
+        emitted[partner] = true;
+        ++fused_;
+      } else {
+        builder.pushOperation(node.code);
+      }
+      emitted[index] = true;
+      if (node.uses > 1) {
+        slots[index] = temporaries++;
+        builder.pushOperation(OpCode::kStore, slots[index]);
+      }
+    }
+  }
+  return builder.build();
+}
+
+/// @brief get number of unique nodes
+/// @return size_t
+std::size_t ExpressionDag::getSize() const { return nodes_.size(); }
+/// @brief get number of repeated operations merged with an equal node
+/// @return size_t
+std::size_t ExpressionDag::getDeduplicatedCount() const {
+  return deduplicated_;
+}
+/// @brief get number of sin and cos pairs fused by the last toProgram()
+/// @return size_t
+std::size_t ExpressionDag::getFusedCount() const { return fused_; }
+
+/// @brief hash of node key
+/// @param key Key
+/// @return size_t
+std::size_t ExpressionDag::KeyHash::operator()(const Key &key) const {
+  std::size_t hash = key.valueBits ^ static_cast<std::size_t>(key.code);
+  for (std::uint32_t arg : key.args) {
+    hash = hash * 0x100000001b3ULL ^ arg;
+  }
+  return hash;
+}
+
+}  // namespace s21
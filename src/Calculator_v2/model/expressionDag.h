@@ -0,0 +1,71 @@
+#ifndef CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_EXPRESSIONDAG_H_
+#define CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_EXPRESSIONDAG_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include "program.h"
+
+namespace s21 {
+
+//! Hash-consed expression graph of a program
+/*!
+  Every node is unique: an operation on the same arguments (in any order for
+  + and *) is looked up instead of added again, so each subexpression is
+  computed once per point, or once per column in batch mode. toProgram()
+  stores nodes used more than once to temporaries on their first evaluation
+  and loads them afterwards. sin(a) and cos(a) are computed together by one
+  kSinCos / kCosSin instruction (kFastSinCos / kFastCosSin for the fast
+  approximations), the second result goes to a temporary.
+  Superinstructions in the source program are split back to plain nodes.
+*/
+class ExpressionDag {
+ public:
+  explicit ExpressionDag(const Program &program);
+  ~ExpressionDag() = default;
+
+  Program toProgram();
+
+  // GETTERS
+  std::size_t getSize() const;
+  std::size_t getDeduplicatedCount() const;
+  std::size_t getFusedCount() const;
+
+ private:
+  //! Node: operation with up to two argument nodes, or a leaf
+  struct Node {
+    OpCode code;
+    double value;  //!< kPushConst only
+    std::uint32_t args[2];
+    std::uint32_t uses;
+  };
+
+  //! Hash-consing key, arguments of commutative operations are sorted
+  struct Key {
+    OpCode code;
+    std::uint64_t valueBits;
+    std::uint32_t args[2];
+
+    bool operator==(const Key &other) const = default;
+  };
+
+  struct KeyHash {
+    std::size_t operator()(const Key &key) const;
+  };
+
+  std::vector<Node> nodes_;
+  std::unordered_map<Key, std::uint32_t, KeyHash> index_;
+  std::uint32_t root_{0};
+  std::size_t deduplicated_{0};
+  std::size_t fused_{0};
+
+  std::uint32_t addNode(OpCode code, double value, std::uint32_t lArg,
+                        std::uint32_t rArg);
+  std::uint32_t findPartner(std::uint32_t index) const;
+};
+
+}  // namespace s21
+
+#endif  // CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_EXPRESSIONDAG_H_
@@ -0,0 +1,373 @@
+#include "expressionParser.h"
+
+#include <cctype>
+#include <charconv>
+#include <cstdlib>
+#include <string>
+
+namespace s21 {
+
+/******************************************************************************
+ *                                                                            *
+ *                          ExpressionParser class                            *
+ *                                                                            *
+ ******************************************************************************/
+
+/// @brief parse and compile an expression, see ExpressionParser
+/// @param expression string
+/// @param mode optimizer mode, kExact by default
+/// @param report optimizer statistics, may be nullptr
+/// @param precision scalar type the program is evaluated in, double by
+/// default
+/// @return Program, throws std::logic_error with Error::message()
+Program ExpressionParser::parse(std::string_view expression,
+                                Optimizer::Mode mode,
+                                Optimizer::Report *report,
+                                Precision precision) {
+  return std::move(tryParse(expression, mode, report, precision).value());
+}
+
+/// @brief parse and compile an expression without exceptions
+/// @param expression string
+/// @param mode optimizer mode, kExact by default
+/// @param report optimizer statistics, may be nullptr
+/// @param precision scalar type the program is evaluated in, double by
+/// default
+/// @return Expected<Program>, the first error found, its views point into
+/// expression
+Expected<Program> ExpressionParser::tryParse(std::string_view expression,
+                                             Optimizer::Mode mode,
+                                             Optimizer::Report *report,
+                                             Precision precision) {
+  clearAll();
+  error_ = Error();
+  if (!parseString(expression)) {
+    return error_;
+  }
+  if (input_.empty()) {
+    return fail({ErrorCode::kEmptyExpression});
+  }
+  if (!convertInfixToPostfix()) {
+    return error_;
+  }
+  return compileOutput(mode, report, precision);
+}
+
+/// @brief record an error
+/// @param error Error
+/// @return Error
+Error ExpressionParser::fail(Error error) {
+  error_ = error;
+  return error_;
+}
+
+/// @brief read some word from input string
+/// @param input string to parse
+/// @param startIndex index of the first letter, moved to the last one
+/// @return found word (string_view into input)
+std::string_view ExpressionParser::readWord(std::string_view input,
+                                            size_t &startIndex) const {
+  size_t index = startIndex;
+  while (index < input.size() &&
+         std::isalpha(static_cast<unsigned char>(input[index]))) {
+    ++index;
+  }
+  std::string_view word = input.substr(startIndex, index - startIndex);
+  startIndex = index - 1;
+  return word;
+}
+
+/// @brief read digits sequence from input string
+/// @param input string to parse
+/// @param index current index, moved past the digits
+/// @return number of digits read
+size_t ExpressionParser::skipDigits(std::string_view input,
+                                    size_t &index) const {
+  size_t start = index;
+  while (index < input.size() &&
+         std::isdigit(static_cast<unsigned char>(input[index]))) {
+    ++index;
+  }
+  return index - start;
+}
+
+/// @brief read double from input string: \d+([.]\d+)?(e([-+])?\d+)?
+/// @param input string to parse
+/// @param startIndex index of the first digit, moved to the last char
+/// @return found number (string_view into input)
+std::string_view ExpressionParser::readDouble(std::string_view input,
+                                              size_t &startIndex) const {
+  size_t index = startIndex;
+  skipDigits(input, index);
+  size_t end = index;
+  if (index < input.size() && input[index] == '.' &&
+      skipDigits(input, ++index) > 0) {
+    end = index;
+  }
+  index = end;
+  if (index < input.size() && (input[index] == 'e' || input[index] == 'E')) {
+    ++index;
+    if (index < input.size() && (input[index] == '+' || input[index] == '-')) {
+      ++index;
+    }
+    if (skipDigits(input, index) > 0) {
+      end = index;
+    }
+  }
+  std::string_view number = input.substr(startIndex, end - startIndex);
+  startIndex = end - 1;
+  return number;
+}
+
+/// @brief convert number read by readDouble to double
+/// @param number string_view
+/// @return double
+double ExpressionParser::toDouble(std::string_view number) const {
+  double value = 0.0;
+  std::from_chars_result result =
+      std::from_chars(number.data(), number.data() + number.size(), value);
+  if (result.ec == std::errc::result_out_of_range) {
+    value = std::strtod(std::string(number).c_str(), nullptr);
+  }
+  return value;
+}
+
+/// @brief clear all containers (input_, output_, stack_)
+void ExpressionParser::clearAll() {
+  while (!input_.empty()) {
+    input_.pop();
+  }
+  while (!output_.empty()) {
+    output_.pop();
+  }
+  while (!stack_.empty()) {
+    stack_.pop();
+  }
+}
+
+/// @brief push token to queue input_
+/// @param token token name
+/// @param position offset of the token in the expression
+/// @return bool, false for unknown tokens
+bool ExpressionParser::pushToken(std::string_view token,
+                                 std::size_t position) {
+  const Token *found = TokenTable::find(token);
+  if (found == nullptr) {
+    fail({ErrorCode::kIncorrectInput, position, token});
+    return false;
+  }
+  input_.push(*found);
+  input_.back().setPosition(position);
+  return true;
+}
+
+/// @brief subfunction helper, change +- to unary
+/// @param input queue<Token>
+void ExpressionParser::changeUnaryPlusMinus(std::queue<Token> &input) {
+  if (input.front().getName() == "+" || input.front().getName() == "-") {
+    if (input.front().getName() == "-") {
+      input.front().makeUnaryNegative();
+    } else {
+      input.pop();
+    }
+  }
+}
+
+/// @brief parse input string in a single pass, O(input.size())
+/// @param input string
+/// @return bool, false at the first unknown token
+bool ExpressionParser::parseString(std::string_view input) {
+  for (size_t i = 0; i < input.size(); ++i) {
+    unsigned char symbol = input[i];
+    std::size_t position = i;
+    if (std::isalpha(symbol)) {
+      if (!pushToken(readWord(input, i), position)) {
+        return false;
+      }
+    } else if (std::isdigit(symbol)) {
+      Token tokenTemp;
+      std::string_view digit = readDouble(input, i);
+      tokenTemp.makeNumber(digit, toDouble(digit));
+      tokenTemp.setPosition(position);
+      input_.push(tokenTemp);
+    } else if (!pushToken(input.substr(i, 1), position)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// @brief delete spaces, change +- to unary, add * if necessary
+void ExpressionParser::prepairInput() {
+  changeUnaryPlusMinus(input_);
+  moveFromInputToOutput();
+  for (; !input_.empty() && !output_.empty(); moveFromInputToOutput()) {
+    while (!input_.empty() && input_.front().getName() == "space") {
+      input_.pop();
+    }
+    if (input_.empty()) {
+      break;
+    }
+    if (output_.back().getType() != Type::kNumber &&
+        output_.back().getType() != Type::kCloseBracket &&
+        output_.back().getType() != Type::kUnaryPostfixOperator) {
+      changeUnaryPlusMinus(input_);
+      if (input_.empty()) {
+        break;
+      }
+    }
+    if (kMultAddMatrix_[output_.back().getType()][input_.front().getType()]) {
+      output_.push(TokenTable::getMultiply());
+      output_.back().setPosition(input_.front().getPosition());
+    }
+  }
+  input_.swap(output_);
+}
+
+/// @brief Check a sequence of prepaired tokens
+/// @return bool, false at the first error
+bool ExpressionParser::checkSequence() {
+  int brkCheck = (input_.front().getType() == Type::kOpenBracket ||
+                  input_.front().getType() == Type::kCloseBracket);
+  prepairInput();
+  moveFromInputToOutput();
+  for (; !input_.empty() && !output_.empty(); moveFromInputToOutput()) {
+    if (!kAdjacencyMatrix_[output_.back().getType()]
+                          [input_.front().getType()]) {
+      fail({ErrorCode::kWrongSequence, input_.front().getPosition(),
+            output_.back().getName(), input_.front().getName()});
+      return false;
+    }
+    if (input_.front().getType() == Type::kOpenBracket) {
+      brkCheck++;
+    } else if (input_.front().getType() == Type::kCloseBracket) {
+      brkCheck--;
+    }
+    if (output_.back().getName() == "/" and input_.front().getName() == "0") {
+      fail({ErrorCode::kDivisionByZero, input_.front().getPosition()});
+      return false;
+    }
+  }
+  input_.swap(output_);
+  if (input_.empty()) {
+    fail({ErrorCode::kEmptyExpression});
+    return false;
+  }
+  if (!kFirstToken_[input_.front().getType()]) {
+    fail({ErrorCode::kWrongFirstToken, input_.front().getPosition(),
+          input_.front().getName()});
+    return false;
+  }
+  if (!kLastToken_[input_.back().getType()]) {
+    fail({ErrorCode::kWrongLastToken, input_.back().getPosition(),
+          input_.back().getName()});
+    return false;
+  }
+  if (brkCheck != 0) {
+    fail({ErrorCode::kUnbalancedBrackets, input_.back().getPosition(), {}, {},
+          brkCheck});
+    return false;
+  }
+  return true;
+}
+
+/// @brief move from input to output queue
+void ExpressionParser::moveFromInputToOutput() {
+  if (!input_.empty()) {
+    output_.push(input_.front());
+    input_.pop();
+  }
+}
+
+/// @brief move from input queue to stack
+void ExpressionParser::moveFromInputToStack() {
+  if (!input_.empty()) {
+    stack_.push(input_.front());
+    input_.pop();
+  }
+}
+
+/// @brief move from stack to output queue
+void ExpressionParser::moveFromStackToOutput() {
+  if (!stack_.empty()) {
+    output_.push(stack_.top());
+    stack_.pop();
+  }
+}
+
+/// @brief convert infix input_ queue to postfix output_ queue, Dijkstra's
+/// algorithm
+/// @return bool, false if the sequence check failed
+bool ExpressionParser::convertInfixToPostfix() {
+  if (!checkSequence()) {
+    return false;
+  }
+  while (!input_.empty()) {
+    switch (input_.front().getType()) {
+      case Type::kNumber:
+      case Type::kUnaryPostfixOperator:
+        moveFromInputToOutput();
+        break;
+      case Type::kUnaryFunction:
+      case Type::kUnaryPrefixOperator:
+      case Type::kOpenBracket:
+        moveFromInputToStack();
+        break;
+      case Type::kBinaryOperator:
+        while (
+            !stack_.empty() && !input_.empty() &&
+            ((input_.front().getAssociativity() == Associativity::kLeft &&
+              input_.front().getPrecedence() <= stack_.top().getPrecedence()) ||
+             (input_.front().getAssociativity() == Associativity::kRight &&
+              input_.front().getPrecedence() < stack_.top().getPrecedence())) &&
+            stack_.top().getType() != Type::kOpenBracket) {
+          moveFromStackToOutput();
+        }
+        moveFromInputToStack();
+        break;
+      case Type::kCloseBracket:
+        while (!stack_.empty() &&
+               stack_.top().getType() != Type::kOpenBracket) {
+          moveFromStackToOutput();
+        }
+        if (!stack_.empty()) {
+          stack_.pop();
+          if (!stack_.empty() &&
+              stack_.top().getType() == Type::kUnaryFunction) {
+            moveFromStackToOutput();
+          }
+        }
+        if (!input_.empty()) {
+          input_.pop();
+        }
+        break;
+      default:
+        break;
+    }
+  }
+  while (!stack_.empty()) {
+    moveFromStackToOutput();
+  }
+  return true;
+}
+
+/// @brief compile postfix output_ queue to optimized bytecode
+/// @param mode optimizer mode
+/// @param report optimizer statistics, may be nullptr
+/// @param precision scalar type the program is evaluated in
+/// @return Program
+Program ExpressionParser::compileOutput(Optimizer::Mode mode,
+                                        Optimizer::Report *report,
+                                        Precision precision) {
+  Program::Builder builder;
+  for (; !output_.empty(); output_.pop()) {
+    if (output_.front().getOpCode() == OpCode::kPushConst) {
+      builder.pushConstant(output_.front().getValue());
+    } else {
+      builder.pushOperation(output_.front().getOpCode());
+    }
+  }
+  return Optimizer::optimize(builder.build(), report, mode, precision);
+}
+
+}  // namespace s21
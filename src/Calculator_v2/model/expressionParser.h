@@ -0,0 +1,92 @@
+#ifndef CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_EXPRESSIONPARSER_H_
+#define CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_EXPRESSIONPARSER_H_
+
+#include <queue>
+#include <stack>
+#include <string_view>
+
+#include "expected.h"
+#include "optimizer.h"
+#include "program.h"
+#include "token.h"
+
+namespace s21 {
+
+//! Parser of infix expressions into bytecode programs
+/*!
+  parse() runs the whole pipeline: tokenizing, unary signs and implicit
+  multiplications, the token sequence check, Dijkstra's conversion to
+  postfix and the optimized compilation. The token containers are the only
+  state and belong to the parser object, so a parser is cheap to create and
+  parsers on different threads are independent. tryParse() returns the first
+  error with the position of its token without unwinding, no message string
+  is built until Error::message(). The token containers may still allocate
+  on the way to the error. parse() throws it as std::logic_error.
+*/
+class ExpressionParser {
+ public:
+  ExpressionParser() = default;
+  ~ExpressionParser() = default;
+
+  Program parse(std::string_view expression,
+                Optimizer::Mode mode = Optimizer::Mode::kExact,
+                Optimizer::Report *report = nullptr,
+                Precision precision = Precision::kDouble);
+  Expected<Program> tryParse(std::string_view expression,
+                             Optimizer::Mode mode = Optimizer::Mode::kExact,
+                             Optimizer::Report *report = nullptr,
+                             Precision precision = Precision::kDouble);
+
+ private:
+  std::stack<Token> stack_;
+  std::queue<Token> input_;
+  std::queue<Token> output_;
+  Error error_;
+
+  bool parseString(std::string_view input);
+  void prepairInput();
+  bool checkSequence();
+  bool convertInfixToPostfix();
+  Program compileOutput(Optimizer::Mode mode, Optimizer::Report *report,
+                        Precision precision);
+  void clearAll();
+  Error fail(Error error);
+
+  // FUNCTION HELPERS
+  std::string_view readWord(std::string_view input, size_t &startIndex) const;
+  size_t skipDigits(std::string_view input, size_t &index) const;
+  std::string_view readDouble(std::string_view input, size_t &startIndex) const;
+  double toDouble(std::string_view number) const;
+  bool pushToken(std::string_view token, std::size_t position);
+  void changeUnaryPlusMinus(std::queue<Token> &input);
+  void moveFromInputToOutput();
+  void moveFromInputToStack();
+  void moveFromStackToOutput();
+
+  static constexpr bool kAdjacencyMatrix_[kNumTokenType][kNumTokenType] = {
+      {0, 1, 0, 1, 0, 0, 1},  // kNumber
+      {1, 0, 1, 0, 1, 1, 0},  // kBinaryOperator
+      {1, 0, 1, 0, 1, 1, 0},  // kUnaryPrefixOperator
+      {0, 1, 0, 1, 0, 0, 1},  // kUnaryPostfixOperator
+      {0, 0, 0, 0, 0, 1, 0},  // kUnaryFunction
+      {1, 0, 1, 0, 1, 1, 0},  // kOpenBracket
+      {0, 1, 0, 1, 0, 0, 1},  // kCloseBracket
+  };
+  static constexpr bool kFirstToken_[kNumTokenType] = {1, 0, 1, 0, 1, 1, 0};
+  static constexpr bool kLastToken_[kNumTokenType] = {1, 0, 0, 1, 0, 0, 1};
+
+  // check if multiplication is necessary
+  static constexpr bool kMultAddMatrix_[kNumTokenType][kNumTokenType] = {
+      {1, 0, 0, 0, 1, 1, 0},  // kNumber
+      {0, 0, 0, 0, 0, 0, 0},  // kBinaryOperator
+      {0, 0, 0, 0, 0, 0, 0},  // kUnaryPrefixOperator
+      {1, 0, 1, 0, 1, 1, 0},  // kUnaryPostfixOperator
+      {0, 0, 0, 0, 0, 0, 0},  // kUnaryFunction
+      {0, 0, 0, 0, 0, 0, 0},  // kOpenBracket
+      {1, 0, 1, 0, 1, 1, 0},  // kCloseBracket
+  };
+};
+
+}  // namespace s21
+
+#endif  // CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_EXPRESSIONPARSER_H_
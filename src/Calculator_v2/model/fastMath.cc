@@ -0,0 +1,68 @@
+#include "fastMath.h"
+
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+namespace s21 {
+
+namespace {
+
+constexpr double kRoundMagic = 0x1.8p52;
+constexpr double kTwoOverPi = 6.36619772367581382433e-01;
+constexpr double kMaxTrigArg = 0x1p20;
+
+template <std::size_t K>
+double polynomial(double x, const double (&coef)[K]) {
+  double result = coef[0];
+  for (std::size_t i = 1; i < K; ++i) {
+    result = result * x + coef[i];
+  }
+  return result;
+}
+
+//! Reduction by pi / 2, sin and cos on [-pi/4, pi/4]
+struct Reduced {
+  std::int64_t q;  //!< quadrant
+  double s;
+  double c;
+
+  explicit Reduced(double x) {
+    double t = x * kTwoOverPi + kRoundMagic;
+    q = std::bit_cast<std::int64_t>(t);
+    double qd = t - kRoundMagic;
+    double z = (x - qd * FastMath::kPio2Hi) - qd * FastMath::kPio2Lo;
+    double zz = z * z;
+    s = z + z * zz * polynomial(zz, FastMath::kSinCoef);
+    c = (1.0 - 0.5 * zz) + zz * zz * polynomial(zz, FastMath::kCosCoef);
+  }
+};
+
+}  // namespace
+
+/// @brief fast sin
+/// @param x argument
+/// @return double
+double FastMath::sin(double x) {
+  if (!(x <= kMaxTrigArg && x >= -kMaxTrigArg)) {
+    return std::sin(x);
+  }
+  Reduced reduced(x);
+  double r = (reduced.q & 1) != 0 ? reduced.c : reduced.s;
+  return (reduced.q & 2) != 0 ? -r : r;
+}
+
+/// @brief fast cos
+/// @param x argument
+/// @return double
+double FastMath::cos(double x) {
+  if (!(x <= kMaxTrigArg && x >= -kMaxTrigArg)) {
+    return std::cos(x);
+  }
+  Reduced reduced(x);
+  double r = (reduced.q & 1) != 0 ? reduced.s : reduced.c;
+  return ((reduced.q + 1) & 2) != 0 ? -r : r;
+}
+
+}  // namespace s21
@@ -0,0 +1,45 @@
+#ifndef CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_FASTMATH_H_
+#define CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_FASTMATH_H_
+
+namespace s21 {
+
+//! Reduced-precision approximations of the fast math mode
+/*!
+  Scalar versions of the kFastSin and kFastCos kernels and the constants
+  the vector kernels in VectorMath share with them. Compared to the exact
+  kernels the reduction by pi / 2 has two parts instead of three and the
+  polynomials are one term shorter, fitted for minimal relative error.
+
+  Error against the exact value, measured on 10^6 random arguments: sin, cos
+  40 ulp max, 10 ulp mean. Arguments outside a kernel's domain (non-finite,
+  |x| > 2^20) go to libm. Vector kernels may contract to FMA, so they can
+  differ from the scalar versions in the last bits.
+
+  The trade of the whole mode, measured by the benchmark on one thread:
+  graphs of sin and cos sums are 0-20% faster, with errors in ulps of
+  max(|y|, 1) up to 45 max and 8 mean, 2411 max and 2.4 mean over 1000
+  random expressions. Near poles the reassociated arguments move the pole:
+  tan(x/3) + sin(x) is off by up to 425714 ulp.
+*/
+class FastMath {
+ public:
+  static double sin(double x);
+  static double cos(double x);
+
+  //! pi / 2 in two parts (fdlibm pio2_1, pio2_1t), the first one has 33
+  //! significant bits so q * kPio2Hi is exact for |q| < 2^20
+  static constexpr double kPio2Hi = 1.57079632673412561417e+00;
+  static constexpr double kPio2Lo = 6.07710050650619224932e-11;
+  static constexpr double kSinCoef[] = {
+      -2.47620487942735172782e-08, 2.75553637786780034532e-06,
+      -1.98412638547167179083e-04, 8.33333332533836047828e-03,
+      -1.66666666666320351098e-01};
+  static constexpr double kCosCoef[] = {
+      2.06500778671693665622e-09, -2.75556064997328385444e-07,
+      2.48015812083409039430e-05, -1.38888888788682397443e-03,
+      4.16666666666073923220e-02};
+};
+
+}  // namespace s21
+
+#endif  // CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_FASTMATH_H_
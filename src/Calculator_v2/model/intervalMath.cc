@@ -0,0 +1,507 @@
+#include "intervalMath.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace s21 {
+
+namespace {
+
+constexpr double kInf = std::numeric_limits<double>::infinity();
+constexpr double kPi = 3.14159265358979323846;
+//! bound of the error of libm and of the fast math approximations, relative
+//! to max(|result|, 1)
+constexpr double kMathError = 0x1p-40;
+//! larger arguments of sin, cos and tan are bounded by their range only
+constexpr double kMaxTrigArg = 0x1p30;
+//! argument and value of the minimum of gamma on (0, inf)
+constexpr double kGammaMinArg = 1.46163214496836234126;
+constexpr double kGammaMin = 0.88560319441088870028;
+
+/// @brief interval of exactly rounded bounds, one ulp outwards
+/// @param lo lower bound
+/// @param hi upper bound
+/// @param discontinuous pole or jump flag
+/// @return Interval, whole if a bound is NaN
+Interval rounded(double lo, double hi, bool discontinuous) {
+  if (std::isnan(lo) || std::isnan(hi)) {
+    return Interval::whole(discontinuous);
+  }
+  return {std::nextafter(lo, -kInf), std::nextafter(hi, kInf), discontinuous};
+}
+
+/// @brief interval of bounds computed by math routines, widened by their
+/// error
+/// @param lo lower bound
+/// @param hi upper bound
+/// @param discontinuous pole or jump flag
+/// @return Interval, whole if a bound is NaN
+Interval widened(double lo, double hi, bool discontinuous) {
+  if (std::isnan(lo) || std::isnan(hi)) {
+    return Interval::whole(discontinuous);
+  }
+  if (std::isfinite(lo)) {
+    lo -= std::max(std::abs(lo), 1.0) * kMathError;
+  }
+  if (std::isfinite(hi)) {
+    hi += std::max(std::abs(hi), 1.0) * kMathError;
+  }
+  return {lo, hi, discontinuous};
+}
+
+/// @brief interval of a monotone function
+/// @param lo value at the lower end of the argument
+/// @param hi value at the upper end of the argument
+/// @param discontinuous pole or jump flag
+/// @return Interval
+Interval monotone(double lo, double hi, bool discontinuous) {
+  return widened(std::min(lo, hi), std::max(lo, hi), discontinuous);
+}
+
+/// @brief check if offset + k * period lies in the interval for some k
+/// @param arg finite interval
+/// @param offset point of the first period
+/// @param period period
+/// @return bool, true near the ends as well
+bool hitsPeriodic(Interval arg, double offset, double period) {
+  constexpr double kTolerance = 1e-9;
+  double k = std::ceil((arg.lo - offset) / period - kTolerance);
+  return offset + k * period <= arg.hi + kTolerance * period;
+}
+
+/// @brief interval of sin or cos
+/// @param arg argument interval
+/// @param isSin sin or cos
+/// @return Interval
+Interval trigonometric(Interval arg, bool isSin) {
+  bool small = arg.lo > -kMaxTrigArg && arg.hi < kMaxTrigArg;
+  if (!small || arg.hi - arg.lo >= 2 * kPi) {
+    return widened(-1, 1, arg.discontinuous);
+  }
+  double lValue = isSin ? std::sin(arg.lo) : std::cos(arg.lo);
+  double rValue = isSin ? std::sin(arg.hi) : std::cos(arg.hi);
+  double maxArg = isSin ? kPi / 2 : 0;
+  double lo = hitsPeriodic(arg, maxArg + kPi, 2 * kPi) ? -1
+                                                        : std::min(lValue, rValue);
+  double hi = hitsPeriodic(arg, maxArg, 2 * kPi) ? 1 : std::max(lValue, rValue);
+  return widened(lo, hi, arg.discontinuous);
+}
+
+/// @brief interval of tan
+/// @param arg argument interval
+/// @return Interval, discontinuous across a pole
+Interval tangent(Interval arg) {
+  bool small = arg.lo > -kMaxTrigArg && arg.hi < kMaxTrigArg;
+  if (!small || arg.hi - arg.lo >= kPi || hitsPeriodic(arg, kPi / 2, kPi)) {
+    return Interval::whole(true);
+  }
+  return monotone(std::tan(arg.lo), std::tan(arg.hi), arg.discontinuous);
+}
+
+/// @brief interval of gamma(x + 1)
+/// @param arg argument interval
+/// @return Interval, discontinuous across a pole
+Interval factorial(Interval arg) {
+  double lo = std::nextafter(arg.lo + 1, -kInf);
+  double hi = std::nextafter(arg.hi + 1, kInf);
+  if (lo <= 0) {
+    // poles at non-positive integers, sign changes between them
+    bool pole = std::floor(std::min(hi, 0.0)) >= lo;
+    return Interval::whole(pole || arg.discontinuous);
+  }
+  double lValue = std::tgamma(lo);
+  double rValue = std::tgamma(hi);
+  if (hi <= kGammaMinArg) {
+    return widened(rValue, lValue, arg.discontinuous);
+  }
+  if (lo >= kGammaMinArg) {
+    return widened(lValue, rValue, arg.discontinuous);
+  }
+  return widened(kGammaMin, std::max(lValue, rValue), arg.discontinuous);
+}
+
+/// @brief interval of a product
+Interval multiply(Interval lArg, Interval rArg, bool discontinuous) {
+  // 0 * inf products are NaN, fmin and fmax skip them: the limit is 0 and
+  // 0 is reached by another product
+  double p1 = lArg.lo * rArg.lo;
+  double p2 = lArg.lo * rArg.hi;
+  double p3 = lArg.hi * rArg.lo;
+  double p4 = lArg.hi * rArg.hi;
+  return rounded(std::fmin(std::fmin(p1, p2), std::fmin(p3, p4)),
+                 std::fmax(std::fmax(p1, p2), std::fmax(p3, p4)),
+                 discontinuous);
+}
+
+/// @brief interval of a quotient
+Interval divide(Interval lArg, Interval rArg, bool discontinuous) {
+  if (rArg.lo <= 0 && rArg.hi >= 0) {
+    return Interval::whole(true);
+  }
+  double q1 = lArg.lo / rArg.lo;
+  double q2 = lArg.lo / rArg.hi;
+  double q3 = lArg.hi / rArg.lo;
+  double q4 = lArg.hi / rArg.hi;
+  return rounded(std::fmin(std::fmin(q1, q2), std::fmin(q3, q4)),
+                 std::fmax(std::fmax(q1, q2), std::fmax(q3, q4)),
+                 discontinuous);
+}
+
+/// @brief interval of pow
+Interval power(Interval lArg, Interval rArg, bool discontinuous) {
+  bool integer = rArg.lo == rArg.hi && std::trunc(rArg.lo) == rArg.lo &&
+                 std::abs(rArg.lo) < 0x1p53;
+  bool hasZero = lArg.lo <= 0 && lArg.hi >= 0;
+  if (integer) {
+    double n = rArg.lo;
+    if (n == 0) {
+      return Interval::point(1);
+    }
+    if (n < 0 && hasZero) {
+      return Interval::whole(true);
+    }
+    double lValue = std::pow(lArg.lo, n);
+    double rValue = std::pow(lArg.hi, n);
+    bool even = std::fmod(n, 2) == 0;
+    if (even && hasZero) {
+      return widened(0, std::max(lValue, rValue), discontinuous);
+    }
+    return monotone(lValue, rValue, discontinuous);
+  }
+  if (lArg.lo < 0) {
+    if (rArg.lo != rArg.hi) {
+      // integer exponents in range, negative bases are defined there
+      return Interval::whole(true);
+    }
+    if (lArg.hi < 0) {
+      return Interval::empty();
+    }
+    lArg.lo = 0;
+  }
+  // monotone in each argument for a non-negative base, extremes at corners
+  double p1 = std::pow(lArg.lo, rArg.lo);
+  double p2 = std::pow(lArg.lo, rArg.hi);
+  double p3 = std::pow(lArg.hi, rArg.lo);
+  double p4 = std::pow(lArg.hi, rArg.hi);
+  bool pole = lArg.lo == 0 && rArg.lo < 0;
+  return widened(std::fmin(std::fmin(p1, p2), std::fmin(p3, p4)),
+                 std::fmax(std::fmax(p1, p2), std::fmax(p3, p4)),
+                 discontinuous || pole);
+}
+
+/// @brief interval of fmod
+Interval modulo(Interval lArg, Interval rArg, bool discontinuous) {
+  if (rArg.lo == 0 && rArg.hi == 0) {
+    return Interval::empty();
+  }
+  if (rArg.lo == rArg.hi && std::isfinite(lArg.lo) &&
+      std::isfinite(lArg.hi)) {
+    double period = std::abs(rArg.lo);
+    double lValue = std::fmod(lArg.lo, period);
+    double rValue = std::fmod(lArg.hi, period);
+    bool oneSign = lArg.lo >= 0 || lArg.hi <= 0;
+    bool continuous =
+        lArg.hi - lArg.lo < period &&
+        ((oneSign && lValue <= rValue) ||
+         (lArg.lo > -period && lArg.hi < period));
+    if (continuous) {
+      // fmod is exact
+      return {lValue, rValue, discontinuous};
+    }
+  }
+  // |fmod(a, b)| < |b| and |fmod(a, b)| <= |a|, sign of a
+  double bound = std::max(std::abs(rArg.lo), std::abs(rArg.hi));
+  double lo = lArg.lo >= 0 ? 0 : std::max(lArg.lo, -bound);
+  double hi = lArg.hi <= 0 ? 0 : std::min(lArg.hi, bound);
+  return {lo, hi, true};
+}
+
+//! Recursive bisection of IntervalMath::sample()
+class Sampler {
+ public:
+  Sampler(const Program &program, std::span<const double> xs, double yMin,
+          double yMax, IntervalMath::Sampling &sampling)
+      : program_(program),
+        xs_(xs),
+        yMin_(yMin),
+        yMax_(yMax),
+        stack_(program.getScratchSize()),
+        points_(program.getScratchSize()),
+        sampling_(sampling) {}
+
+  /// @brief classify points first..last, inclusive
+  /// @param first index of the first point
+  /// @param last index of the last point
+  void run(std::size_t first, std::size_t last) {
+    Interval y = IntervalMath::evaluate(
+        program_, {xs_[first], xs_[last]}, stack_.data());
+    if (y.isEmpty() || y.hi < yMin_ || y.lo > yMax_) {
+      return;
+    }
+    if (y.discontinuous && last - first == 1 &&
+        IntervalMath::isJump(program_, xs_[first], xs_[last],
+                             points_.data())) {
+      sampling_.poles.push_back(first);
+    }
+    bool inside = yMin_ <= y.lo && y.hi <= yMax_;
+    bool leaf = last - first < IntervalMath::kLeafSize;
+    if (last - first <= 1 || (!y.discontinuous && (inside || leaf))) {
+      std::fill(sampling_.visible.begin() + first,
+                sampling_.visible.begin() + last + 1, true);
+      return;
+    }
+    // the halves share the middle point, so every pair of adjacent points
+    // ends up in one of them
+    std::size_t middle = first + (last - first) / 2;
+    run(first, middle);
+    run(middle, last);
+  }
+
+ private:
+  const Program &program_;
+  std::span<const double> xs_;
+  double yMin_;
+  double yMax_;
+  std::vector<Interval> stack_;
+  std::vector<double> points_;
+  IntervalMath::Sampling &sampling_;
+};
+
+}  // namespace
+
+/******************************************************************************
+ *                                                                            *
+ *                               Interval struct                              *
+ *                                                                            *
+ ******************************************************************************/
+
+/// @brief interval of a single value
+/// @param value value
+/// @return Interval
+Interval Interval::point(double value) { return {value, value}; }
+/// @brief interval of no values (NaN everywhere)
+/// @return Interval
+Interval Interval::empty() { return {kInf, -kInf}; }
+/// @brief interval of all values
+/// @param discontinuous pole or jump flag
+/// @return Interval
+Interval Interval::whole(bool discontinuous) {
+  return {-kInf, kInf, discontinuous};
+}
+/// @brief check if interval has no values
+/// @return bool
+bool Interval::isEmpty() const { return !(lo <= hi); }
+
+/******************************************************************************
+ *                                                                            *
+ *                             IntervalMath class                             *
+ *                                                                            *
+ ******************************************************************************/
+
+/// @brief find graph points that may be visible and likely poles
+/// @param program program
+/// @param xs ascending x values
+/// @param yMin min visible y value
+/// @param yMax max visible y value
+/// @return Sampling, points not marked visible are NaN or outside
+/// [yMin, yMax]
+IntervalMath::Sampling IntervalMath::sample(const Program &program,
+                                            std::span<const double> xs,
+                                            double yMin, double yMax) {
+  Sampling sampling;
+  sampling.visible.assign(xs.size(), false);
+  if (!xs.empty()) {
+    Sampler(program, xs, yMin, yMax, sampling).run(0, xs.size() - 1);
+  }
+  return sampling;
+}
+
+/// @brief bound program over an x range
+/// @param program program
+/// @param x x range
+/// @param stack scratch buffer of at least program.getScratchSize() elements
+/// @return Interval
+Interval IntervalMath::evaluate(const Program &program, Interval x,
+                                Interval *stack) {
+  Interval *top = stack;
+  Interval *temporaries = stack + program.getStackDepth();
+  for (const Instruction &instruction : program.getCode()) {
+    switch (instruction.code) {
+      case OpCode::kPushConst:
+        *top++ = Interval::point(program.getConstant(instruction.operand));
+        break;
+      case OpCode::kPushX:
+        *top++ = x;
+        break;
+      case OpCode::kStore:
+        temporaries[instruction.operand] = top[-1];
+        break;
+      case OpCode::kLoad:
+        *top++ = temporaries[instruction.operand];
+        break;
+      case OpCode::kAdd:
+      case OpCode::kSub:
+      case OpCode::kMul:
+      case OpCode::kDiv:
+      case OpCode::kPow:
+      case OpCode::kMod:
+        --top;
+        top[-1] = applyBinary(instruction.code, top[-1], top[0]);
+        break;
+      case OpCode::kAddX:
+      case OpCode::kSubX:
+      case OpCode::kMulX:
+      case OpCode::kDivX:
+        top[-1] = applyBinary(Program::getBaseOperation(instruction.code),
+                              top[-1], x);
+        break;
+      case OpCode::kMulAdd:
+        // fma rounds once, within the bounds of the rounded product and sum
+        top -= 2;
+        top[-1] = applyBinary(OpCode::kAdd,
+                              applyBinary(OpCode::kMul, top[-1], top[0]),
+                              top[1]);
+        break;
+      case OpCode::kMulXAdd:
+        --top;
+        top[-1] = applyBinary(
+            OpCode::kAdd, applyBinary(OpCode::kMul, top[-1], x), top[0]);
+        break;
+      case OpCode::kSinCos:
+      case OpCode::kCosSin:
+      case OpCode::kFastSinCos:
+      case OpCode::kFastCosSin: {
+        auto [first, second] = Program::getSinCosParts(instruction.code);
+        temporaries[instruction.operand] = applyUnary(second, top[-1]);
+        top[-1] = applyUnary(first, top[-1]);
+        break;
+      }
+      default:
+        top[-1] = applyUnary(instruction.code, top[-1]);
+        break;
+    }
+  }
+  return stack[0];
+}
+
+/// @brief check that f jumps between two points: bisect towards the larger
+/// change of f, which tends to 0 where f is continuous and stays at least the
+/// jump across a pole or a jump
+/// @param program program
+/// @param x0 left x value
+/// @param x1 right x value
+/// @param stack scratch buffer of at least program.getScratchSize() elements
+/// @return bool, false if f is continuous between x0 and x1 except at
+/// isolated points
+bool IntervalMath::isJump(const Program &program, double x0, double x1,
+                          double *stack) {
+  double y0 = program.evaluate(x0, stack);
+  double y1 = program.evaluate(x1, stack);
+  double change = std::abs(y1 - y0);
+  for (int i = 0; i < kJumpSteps; ++i) {
+    double middle = x0 + (x1 - x0) / 2;
+    double y = program.evaluate(middle, stack);
+    if (std::isnan(y)) {
+      // an isolated NaN like 0 / 0, f next to it decides
+      middle = std::nextafter(middle, x1);
+      y = program.evaluate(middle, stack);
+    }
+    if (middle <= x0 || middle >= x1 || std::isnan(y)) {
+      break;
+    }
+    if (std::abs(y - y0) >= std::abs(y1 - y)) {
+      x1 = middle;
+      y1 = y;
+    } else {
+      x0 = middle;
+      y0 = y;
+    }
+  }
+  // NaN differences are jumps too
+  return !(std::abs(y1 - y0) <= change / 2);
+}
+
+/// @brief bound unary operation
+/// @param code operation code, fast math codes are bounded as exact ones
+/// @param arg argument interval
+/// @return Interval of the defined values
+Interval IntervalMath::applyUnary(OpCode code, Interval arg) {
+  if (arg.isEmpty()) {
+    return arg;
+  }
+  bool discontinuous = arg.discontinuous;
+  switch (code) {
+    case OpCode::kNegate:
+      return {-arg.hi, -arg.lo, discontinuous};
+    case OpCode::kCos:
+    case OpCode::kFastCos:
+      return trigonometric(arg, false);
+    case OpCode::kSin:
+    case OpCode::kFastSin:
+      return trigonometric(arg, true);
+    case OpCode::kTan:
+      return tangent(arg);
+    case OpCode::kAcos:
+    case OpCode::kAsin:
+      if (arg.hi < -1 || arg.lo > 1) {
+        return Interval::empty();
+      }
+      arg = {std::max(arg.lo, -1.0), std::min(arg.hi, 1.0)};
+      return code == OpCode::kAcos
+                 ? monotone(std::acos(arg.hi), std::acos(arg.lo), discontinuous)
+                 : monotone(std::asin(arg.lo), std::asin(arg.hi),
+                            discontinuous);
+    case OpCode::kAtan:
+      return monotone(std::atan(arg.lo), std::atan(arg.hi), discontinuous);
+    case OpCode::kLn:
+    case OpCode::kLog:
+    case OpCode::kSqrt: {
+      if (arg.hi < 0) {
+        return Interval::empty();
+      }
+      double lo = std::max(arg.lo, 0.0);
+      if (code == OpCode::kSqrt) {
+        return rounded(std::sqrt(lo), std::sqrt(arg.hi), discontinuous);
+      }
+      return code == OpCode::kLog
+                 ? monotone(std::log10(lo), std::log10(arg.hi), discontinuous)
+                 : monotone(std::log(lo), std::log(arg.hi), discontinuous);
+    }
+    case OpCode::kFactorial:
+      return factorial(arg);
+    case OpCode::kPercent:
+      return rounded(arg.lo / 100, arg.hi / 100, discontinuous);
+    default:
+      return Interval::whole(true);
+  }
+}
+
+/// @brief bound binary operation
+/// @param code operation code
+/// @param lArg left argument interval
+/// @param rArg right argument interval
+/// @return Interval of the defined values
+Interval IntervalMath::applyBinary(OpCode code, Interval lArg, Interval rArg) {
+  if (lArg.isEmpty() || rArg.isEmpty()) {
+    return Interval::empty();
+  }
+  bool discontinuous = lArg.discontinuous || rArg.discontinuous;
+  switch (code) {
+    case OpCode::kAdd:
+      return rounded(lArg.lo + rArg.lo, lArg.hi + rArg.hi, discontinuous);
+    case OpCode::kSub:
+      return rounded(lArg.lo - rArg.hi, lArg.hi - rArg.lo, discontinuous);
+    case OpCode::kMul:
+      return multiply(lArg, rArg, discontinuous);
+    case OpCode::kDiv:
+      return divide(lArg, rArg, discontinuous);
+    case OpCode::kPow:
+      return power(lArg, rArg, discontinuous);
+    case OpCode::kMod:
+      return modulo(lArg, rArg, discontinuous);
+    default:
+      return Interval::whole(true);
+  }
+}
+
+}  // namespace s21
@@ -0,0 +1,72 @@
+#ifndef CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_INTERVALMATH_H_
+#define CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_INTERVALMATH_H_
+
+#include <span>
+#include <vector>
+
+#include "program.h"
+
+namespace s21 {
+
+//! Closed interval [lo, hi], empty if lo > hi
+struct Interval {
+  double lo;
+  double hi;
+  bool discontinuous{false};  //!< a pole or jump may lie in the x range
+
+  static Interval point(double value);
+  static Interval empty();
+  static Interval whole(bool discontinuous = false);
+  bool isEmpty() const;
+};
+
+//! Interval evaluation of programs
+/*!
+  evaluate() bounds a program over a range of x: the result contains f(x)
+  for every x of the range where f is not NaN, so an empty interval means f
+  is NaN on the whole range. Bounds are rounded outwards and widened by the
+  error of the math routines (fast math approximations included), so the
+  enclosure holds for every evaluator. It may be much wider than the true
+  range (the same x is bounded independently in each occurrence), but gets
+  tighter as the x range shrinks.
+
+  discontinuous is set when an operation may have a pole or a jump inside
+  the range: division by an interval containing zero, tan across an odd
+  multiple of pi / 2, mod across a multiple of the divisor, ! across a
+  negative integer.
+
+  sample() bisects a sorted grid of x values: ranges bounded outside the y
+  window are skipped, ranges bounded inside it or down to kLeafSize points
+  are marked visible, discontinuous ranges are bisected down to pairs of
+  adjacent points to locate poles.
+
+  isJump() confirms a pole or jump between two points with point
+  evaluation: removable singularities like sin(x) / x at 0 make the
+  intervals discontinuous but leave the graph continuous.
+*/
+class IntervalMath {
+ public:
+  //! Points of a graph to evaluate and likely poles between them
+  struct Sampling {
+    std::vector<bool> visible;  //!< f(x[i]) may be inside the y window
+    std::vector<std::size_t> poles;  //!< f may jump between x[i] and x[i + 1]
+  };
+
+  //! Ranges of x values up to this size are evaluated without bisection
+  static constexpr std::size_t kLeafSize = 64;
+  //! Bisections of isJump(), the pair shrinks by 2^-64
+  static constexpr int kJumpSteps = 64;
+
+  static Sampling sample(const Program &program, std::span<const double> xs,
+                         double yMin, double yMax);
+  static Interval evaluate(const Program &program, Interval x,
+                           Interval *stack);
+  static bool isJump(const Program &program, double x0, double x1,
+                     double *stack);
+  static Interval applyUnary(OpCode code, Interval arg);
+  static Interval applyBinary(OpCode code, Interval lArg, Interval rArg);
+};
+
+}  // namespace s21
+
+#endif  // CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_INTERVALMATH_H_
@@ -0,0 +1,647 @@
+#include "jitProgram.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <vector>
+
+#if defined(__x86_64__) && (defined(__unix__) || defined(__APPLE__))
+#include <sys/mman.h>
+#define S21_JIT_X86_64
+#endif
+
+namespace s21 {
+
+#ifdef S21_JIT_X86_64
+namespace {
+
+// general purpose registers
+constexpr std::uint8_t kRax = 0;
+constexpr std::uint8_t kRcx = 1;
+constexpr std::uint8_t kRdx = 2;
+constexpr std::uint8_t kRbx = 3;
+constexpr std::uint8_t kRsp = 4;
+constexpr std::uint8_t kRsi = 6;
+constexpr std::uint8_t kRdi = 7;
+constexpr std::uint8_t kR12 = 12;
+constexpr std::uint8_t kR13 = 13;
+constexpr std::uint8_t kR14 = 14;
+constexpr std::uint8_t kR15 = 15;
+constexpr std::uint8_t kNoIndex = 0xff;
+
+// xmm0..xmm14 hold the evaluation stack, xmm15 is scratch
+constexpr std::uint8_t kScratchXmm = 15;
+constexpr std::size_t kMaxStackDepth = 15;
+
+// SSE opcodes (second byte after 0x0f)
+constexpr std::uint8_t kSseLoad = 0x10;
+constexpr std::uint8_t kSseStore = 0x11;
+constexpr std::uint8_t kSseUnpackLow = 0x14;
+constexpr std::uint8_t kSseXor = 0x57;
+constexpr std::uint8_t kSseAdd = 0x58;
+constexpr std::uint8_t kSseMul = 0x59;
+constexpr std::uint8_t kSseSub = 0x5c;
+constexpr std::uint8_t kSseDiv = 0x5e;
+// VEX fused multiply-add a = a * b + c (vfmadd213pd / vfmadd213sd)
+constexpr std::uint8_t kFmaPacked = 0xa8;
+constexpr std::uint8_t kFmaScalar = 0xa9;
+constexpr std::uint8_t kPackedPrefix = 0x66;
+constexpr std::uint8_t kScalarPrefix = 0xf2;
+
+constexpr std::int32_t kColumnBytes = Program::kBlockSize * sizeof(double);
+
+//! Memory operand [base + index + disp]
+struct Memory {
+  std::uint8_t base;
+  std::uint8_t index;
+  std::int32_t disp;
+};
+
+//! Minimal x86-64 encoder for the instructions the generator needs
+class Assembler {
+ public:
+  std::vector<std::uint8_t> &getCode() { return code_; }
+  std::size_t getPosition() const { return code_.size(); }
+
+  void emit(std::initializer_list<std::uint8_t> bytes) {
+    code_.insert(code_.end(), bytes);
+  }
+  void emit32(std::uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+      code_.push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+    }
+  }
+  void emit64(std::uint64_t value) {
+    emit32(static_cast<std::uint32_t>(value));
+    emit32(static_cast<std::uint32_t>(value >> 32));
+  }
+
+  void push(std::uint8_t reg) {
+    if (reg >= 8) emit({0x41});
+    emit({static_cast<std::uint8_t>(0x50 + (reg & 7))});
+  }
+  void pop(std::uint8_t reg) {
+    if (reg >= 8) emit({0x41});
+    emit({static_cast<std::uint8_t>(0x58 + (reg & 7))});
+  }
+  void ret() { emit({0xc3}); }
+
+  // reg-reg instruction with REX.W, reg field = src, r/m field = dst
+  void aluRegReg(std::uint8_t opcode, std::uint8_t dst, std::uint8_t src) {
+    emit({static_cast<std::uint8_t>(0x48 | (src >> 3) << 2 | dst >> 3), opcode,
+          static_cast<std::uint8_t>(0xc0 | (src & 7) << 3 | (dst & 7))});
+  }
+  void mov(std::uint8_t dst, std::uint8_t src) { aluRegReg(0x89, dst, src); }
+  void xorSelf(std::uint8_t reg) { aluRegReg(0x31, reg, reg); }
+  void cmp(std::uint8_t lhs, std::uint8_t rhs) { aluRegReg(0x39, lhs, rhs); }
+
+  // group instruction on a register with 8-bit immediate
+  void aluImm8(std::uint8_t opcode, std::uint8_t extension, std::uint8_t reg,
+               std::uint8_t value) {
+    emit({static_cast<std::uint8_t>(0x48 | reg >> 3), opcode,
+          static_cast<std::uint8_t>(0xc0 | extension << 3 | (reg & 7)), value});
+  }
+  void addImm(std::uint8_t reg, std::uint8_t value) {
+    aluImm8(0x83, 0, reg, value);
+  }
+  void subImm(std::uint8_t reg, std::uint8_t value) {
+    aluImm8(0x83, 5, reg, value);
+  }
+  void shl(std::uint8_t reg, std::uint8_t count) {
+    aluImm8(0xc1, 4, reg, count);
+  }
+  void shr(std::uint8_t reg, std::uint8_t count) {
+    aluImm8(0xc1, 5, reg, count);
+  }
+
+  void movImm32(std::uint8_t reg, std::uint32_t value) {
+    if (reg >= 8) emit({0x41});
+    emit({static_cast<std::uint8_t>(0xb8 + (reg & 7))});
+    emit32(value);
+  }
+  void movImm64(std::uint8_t reg, std::uint64_t value) {
+    emit({static_cast<std::uint8_t>(0x48 | reg >> 3),
+          static_cast<std::uint8_t>(0xb8 + (reg & 7))});
+    emit64(value);
+  }
+  void lea(std::uint8_t reg, Memory memory) {
+    rex(true, reg, memory);
+    emit({0x8d});
+    modrm(reg, memory);
+  }
+  void call(const void *function) {
+    movImm64(kRax, reinterpret_cast<std::uint64_t>(function));
+    emit({0xff, 0xd0});
+  }
+  // jb back to an earlier position
+  void jumpBelow(std::size_t target) {
+    emit({0x0f, 0x82});
+    emit32(static_cast<std::uint32_t>(static_cast<std::int64_t>(target) -
+                                      static_cast<std::int64_t>(code_.size()) -
+                                      4));
+  }
+
+  void sse(std::uint8_t prefix, std::uint8_t opcode, std::uint8_t dst,
+           std::uint8_t src) {
+    emit({prefix});
+    if ((dst | src) >= 8) {
+      emit({static_cast<std::uint8_t>(0x40 | (dst >> 3) << 2 | src >> 3)});
+    }
+    emit({0x0f, opcode,
+          static_cast<std::uint8_t>(0xc0 | (dst & 7) << 3 | (src & 7))});
+  }
+  void sse(std::uint8_t prefix, std::uint8_t opcode, std::uint8_t xmm,
+           Memory memory) {
+    emit({prefix});
+    rex(false, xmm, memory);
+    emit({0x0f, opcode});
+    modrm(xmm, memory);
+  }
+  // VEX.128.66.0F38.W1 three-operand instruction, dst = op(dst, src1, src2)
+  void vex(std::uint8_t opcode, std::uint8_t dst, std::uint8_t src1,
+           std::uint8_t src2) {
+    emit({0xc4,
+          static_cast<std::uint8_t>((~dst >> 3 & 1) << 7 | 1 << 6 |
+                                    (~src2 >> 3 & 1) << 5 | 0x02),
+          static_cast<std::uint8_t>(0x80 | (~src1 & 15) << 3 | 0x01), opcode,
+          static_cast<std::uint8_t>(0xc0 | (dst & 7) << 3 | (src2 & 7))});
+  }
+  // movq xmm, r64
+  void movq(std::uint8_t xmm, std::uint8_t reg) {
+    emit({kPackedPrefix,
+          static_cast<std::uint8_t>(0x48 | (xmm >> 3) << 2 | reg >> 3), 0x0f,
+          0x6e, static_cast<std::uint8_t>(0xc0 | (xmm & 7) << 3 | (reg & 7))});
+  }
+
+ private:
+  std::vector<std::uint8_t> code_;
+
+  void rex(bool wide, std::uint8_t reg, Memory memory) {
+    std::uint8_t index = memory.index == kNoIndex ? 0 : memory.index;
+    std::uint8_t prefix = 0x40 | wide << 3 | (reg >> 3) << 2 |
+                          (index >> 3) << 1 | memory.base >> 3;
+    if (prefix != 0x40) {
+      emit({prefix});
+    }
+  }
+  // always [base + index + disp32] through a SIB byte
+  void modrm(std::uint8_t reg, Memory memory) {
+    std::uint8_t index = memory.index == kNoIndex ? 4 : memory.index & 7;
+    emit({static_cast<std::uint8_t>(0x84 | (reg & 7) << 3),
+          static_cast<std::uint8_t>(index << 3 | (memory.base & 7))});
+    emit32(static_cast<std::uint32_t>(memory.disp));
+  }
+};
+
+double unaryHelper(int code, double arg) {
+  return Program::applyUnary(static_cast<OpCode>(code), arg);
+}
+
+double binaryHelper(int code, double lArg, double rArg) {
+  return Program::applyBinary(static_cast<OpCode>(code), lArg, rArg);
+}
+
+void unaryColumnHelper(int code, double *column, std::size_t size) {
+  Program::applyUnary(static_cast<OpCode>(code), column, size);
+}
+
+void binaryColumnHelper(int code, double *lColumn, const double *rColumn,
+                        std::size_t size) {
+  Program::applyBinary(static_cast<OpCode>(code), lColumn, rColumn, size);
+}
+
+double mulAddHelper(double a, double b, double c) { return std::fma(a, b, c); }
+
+void mulAddColumnHelper(double *column, const double *mColumn,
+                        const double *aColumn, std::size_t size) {
+  Program::applyMulAdd(column, mColumn, aColumn, size);
+}
+
+double sinCosHelper(int code, double arg, double *stored) {
+  auto [first, second] = Program::getSinCosParts(static_cast<OpCode>(code));
+  *stored = Program::applyUnary(second, arg);
+  return Program::applyUnary(first, arg);
+}
+
+void sinCosColumnHelper(int code, double *column, double *stored,
+                        std::size_t size) {
+  Program::applySinCos(static_cast<OpCode>(code), column, stored, size);
+}
+
+bool hasFma() {
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("fma");
+}
+
+//! Lowers a program to one entry point
+/*!
+  Stack slot i lives in xmm i inside a segment (a run of inline operations)
+  and in memory between segments: scratch[i] for the scalar entry, column i
+  for the block entry, where each segment is a loop over the block. Helper
+  calls for other operations happen between segments.
+*/
+class CodeGenerator {
+ public:
+  CodeGenerator(const Program &program, bool block, Assembler &assembler)
+      : program_(program), block_(block), fma_(hasFma()), as_(assembler) {}
+
+  void generate() {
+    prologue();
+    for (const Instruction &instruction : program_.getCode()) {
+      lower(instruction);
+    }
+    openSegment();
+    toRegister(0);
+    if (block_) {
+      as_.sse(kPackedPrefix, kSseStore, 0, Memory{kR12, kR15, 0});
+    }
+    inRegister_[0] = false;  // the result needs no store
+    closeSegment();
+    epilogue();
+  }
+
+ private:
+  const Program &program_;
+  bool block_;
+  bool fma_;  //!< inline vfmadd, helper call otherwise
+  Assembler &as_;
+  std::vector<bool> inRegister_;  //!< per stack slot
+  bool segmentOpen_{false};
+  std::size_t loopStart_{0};
+
+  std::uint8_t prefix() const { return block_ ? kPackedPrefix : kScalarPrefix; }
+
+  // memory of stack slot (or temporary after the stack), current element
+  Memory slot(std::size_t index) const {
+    if (block_) {
+      return {kR13, kR15, static_cast<std::int32_t>(index) * kColumnBytes};
+    }
+    return {kRbx, kNoIndex, static_cast<std::int32_t>(index * sizeof(double))};
+  }
+  Memory column(std::size_t index) const {
+    return {kR13, kNoIndex, static_cast<std::int32_t>(index) * kColumnBytes};
+  }
+  Memory temporary(std::uint32_t index) const {
+    return slot(program_.getStackDepth() + index);
+  }
+  Memory xValue() const {
+    return block_ ? Memory{kRbx, kR15, 0} : Memory{kRsp, kNoIndex, 0};
+  }
+
+  void prologue() {
+    for (std::uint8_t reg : {kRbx, kR12, kR13, kR14, kR15}) {
+      as_.push(reg);
+    }
+    as_.subImm(kRsp, 16);  // keeps rsp 16-byte aligned for calls
+    if (block_) {
+      as_.mov(kRbx, kRdi);
+      as_.mov(kR12, kRsi);
+      as_.mov(kR13, kRdx);
+      as_.mov(kR14, kRcx);
+      as_.shl(kR14, 3);  // size in bytes
+    } else {
+      as_.sse(kScalarPrefix, kSseStore, 0, Memory{kRsp, kNoIndex, 0});
+      as_.mov(kRbx, kRdi);
+    }
+  }
+
+  void epilogue() {
+    as_.addImm(kRsp, 16);
+    for (std::uint8_t reg : {kR15, kR14, kR13, kR12, kRbx}) {
+      as_.pop(reg);
+    }
+    as_.ret();
+  }
+
+  void openSegment() {
+    if (!segmentOpen_ && block_) {
+      as_.xorSelf(kR15);
+      loopStart_ = as_.getPosition();
+    }
+    segmentOpen_ = true;
+  }
+
+  // store register slots, close the loop
+  void closeSegment() {
+    if (!segmentOpen_) {
+      return;
+    }
+    for (std::size_t i = 0; i < inRegister_.size(); ++i) {
+      if (inRegister_[i]) {
+        as_.sse(prefix(), kSseStore, static_cast<std::uint8_t>(i), slot(i));
+        inRegister_[i] = false;
+      }
+    }
+    if (block_) {
+      as_.addImm(kR15, 2 * sizeof(double));
+      as_.cmp(kR15, kR14);
+      as_.jumpBelow(loopStart_);
+    }
+    segmentOpen_ = false;
+  }
+
+  void toRegister(std::size_t index) {
+    if (!inRegister_[index]) {
+      as_.sse(prefix(), kSseLoad, static_cast<std::uint8_t>(index),
+              slot(index));
+      inRegister_[index] = true;
+    }
+  }
+
+  void loadConstant(std::uint8_t xmm, double value) {
+    as_.movImm64(kRax, std::bit_cast<std::uint64_t>(value));
+    as_.movq(xmm, kRax);
+    if (block_) {
+      as_.sse(kPackedPrefix, kSseUnpackLow, xmm, xmm);
+    }
+  }
+
+  void lower(const Instruction &instruction) {
+    std::size_t depth = inRegister_.size();
+    std::uint8_t top = static_cast<std::uint8_t>(depth - 1);
+    switch (instruction.code) {
+      case OpCode::kPushConst:
+        openSegment();
+        loadConstant(static_cast<std::uint8_t>(depth),
+                     program_.getConstant(instruction.operand));
+        inRegister_.push_back(true);
+        break;
+      case OpCode::kPushX:
+        openSegment();
+        as_.sse(prefix(), kSseLoad, static_cast<std::uint8_t>(depth), xValue());
+        inRegister_.push_back(true);
+        break;
+      case OpCode::kLoad:
+        openSegment();
+        as_.sse(prefix(), kSseLoad, static_cast<std::uint8_t>(depth),
+                temporary(instruction.operand));
+        inRegister_.push_back(true);
+        break;
+      case OpCode::kStore:
+        openSegment();
+        toRegister(top);
+        as_.sse(prefix(), kSseStore, top, temporary(instruction.operand));
+        break;
+      case OpCode::kAdd:
+      case OpCode::kSub:
+      case OpCode::kMul:
+      case OpCode::kDiv:
+        openSegment();
+        toRegister(top - 1);
+        toRegister(top);
+        as_.sse(prefix(), arithmeticOpcode(instruction.code), top - 1, top);
+        inRegister_.pop_back();
+        break;
+      case OpCode::kAddX:
+      case OpCode::kSubX:
+      case OpCode::kMulX:
+      case OpCode::kDivX:
+        openSegment();
+        toRegister(top);
+        as_.sse(prefix(), kSseLoad, kScratchXmm, xValue());
+        as_.sse(prefix(),
+                arithmeticOpcode(Program::getBaseOperation(instruction.code)),
+                top, kScratchXmm);
+        break;
+      case OpCode::kMulAdd:
+        if (fma_) {
+          openSegment();
+          toRegister(top - 2);
+          toRegister(top - 1);
+          toRegister(top);
+          as_.vex(block_ ? kFmaPacked : kFmaScalar, top - 2, top - 1, top);
+        } else {
+          closeSegment();
+          callMulAdd(top - 2, slot(top - 1), top);
+        }
+        inRegister_.resize(depth - 2);
+        break;
+      case OpCode::kMulXAdd:
+        if (fma_) {
+          openSegment();
+          toRegister(top - 1);
+          toRegister(top);
+          as_.sse(prefix(), kSseLoad, kScratchXmm, xValue());
+          as_.vex(block_ ? kFmaPacked : kFmaScalar, top - 1, kScratchXmm, top);
+        } else {
+          closeSegment();
+          callMulAdd(top - 1, xValue(), top);
+        }
+        inRegister_.pop_back();
+        break;
+      case OpCode::kSinCos:
+      case OpCode::kCosSin:
+      case OpCode::kFastSinCos:
+      case OpCode::kFastCosSin:
+        closeSegment();
+        callSinCos(instruction.code, top, instruction.operand);
+        break;
+      case OpCode::kNegate:
+        openSegment();
+        toRegister(top);
+        loadConstant(kScratchXmm, -0.0);
+        as_.sse(kPackedPrefix, kSseXor, top, kScratchXmm);
+        break;
+      case OpCode::kPercent:
+        openSegment();
+        toRegister(top);
+        loadConstant(kScratchXmm, 100.0);
+        as_.sse(prefix(), kSseDiv, top, kScratchXmm);
+        break;
+      default:
+        closeSegment();
+        if (Program::getArity(instruction.code) == 2) {
+          callBinary(instruction.code, top - 1);
+          inRegister_.pop_back();
+        } else {
+          callUnary(instruction.code, top);
+        }
+        break;
+    }
+  }
+
+  static std::uint8_t arithmeticOpcode(OpCode code) {
+    switch (code) {
+      case OpCode::kAdd:
+        return kSseAdd;
+      case OpCode::kSub:
+        return kSseSub;
+      case OpCode::kMul:
+        return kSseMul;
+      default:
+        return kSseDiv;
+    }
+  }
+
+  void callUnary(OpCode code, std::size_t index) {
+    as_.movImm32(kRdi, static_cast<std::uint32_t>(code));
+    if (block_) {
+      as_.lea(kRsi, column(index));
+      as_.mov(kRdx, kR14);
+      as_.shr(kRdx, 3);
+      as_.call(reinterpret_cast<const void *>(&unaryColumnHelper));
+    } else {
+      as_.sse(kScalarPrefix, kSseLoad, 0, slot(index));
+      as_.call(reinterpret_cast<const void *>(&unaryHelper));
+      as_.sse(kScalarPrefix, kSseStore, 0, slot(index));
+    }
+  }
+
+  // slot index = slot index * factor + slot addend, stack in memory
+  void callMulAdd(std::size_t index, Memory factor, std::size_t addend) {
+    if (block_) {
+      as_.lea(kRdi, column(index));
+      Memory factorColumn = factor;
+      factorColumn.index = kNoIndex;  // x or stack column without the offset
+      as_.lea(kRsi, factorColumn);
+      as_.lea(kRdx, column(addend));
+      as_.mov(kRcx, kR14);
+      as_.shr(kRcx, 3);
+      as_.call(reinterpret_cast<const void *>(&mulAddColumnHelper));
+    } else {
+      as_.sse(kScalarPrefix, kSseLoad, 0, slot(index));
+      as_.sse(kScalarPrefix, kSseLoad, 1, factor);
+      as_.sse(kScalarPrefix, kSseLoad, 2, slot(addend));
+      as_.call(reinterpret_cast<const void *>(&mulAddHelper));
+      as_.sse(kScalarPrefix, kSseStore, 0, slot(index));
+    }
+  }
+
+  void callSinCos(OpCode code, std::size_t index, std::uint32_t stored) {
+    as_.movImm32(kRdi, static_cast<std::uint32_t>(code));
+    if (block_) {
+      as_.lea(kRsi, column(index));
+      as_.lea(kRdx, column(program_.getStackDepth() + stored));
+      as_.mov(kRcx, kR14);
+      as_.shr(kRcx, 3);
+      as_.call(reinterpret_cast<const void *>(&sinCosColumnHelper));
+    } else {
+      as_.sse(kScalarPrefix, kSseLoad, 0, slot(index));
+      as_.lea(kRsi, temporary(stored));
+      as_.call(reinterpret_cast<const void *>(&sinCosHelper));
+      as_.sse(kScalarPrefix, kSseStore, 0, slot(index));
+    }
+  }
+
+  void callBinary(OpCode code, std::size_t index) {
+    as_.movImm32(kRdi, static_cast<std::uint32_t>(code));
+    if (block_) {
+      as_.lea(kRsi, column(index));
+      as_.lea(kRdx, column(index + 1));
+      as_.mov(kRcx, kR14);
+      as_.shr(kRcx, 3);
+      as_.call(reinterpret_cast<const void *>(&binaryColumnHelper));
+    } else {
+      as_.sse(kScalarPrefix, kSseLoad, 0, slot(index));
+      as_.sse(kScalarPrefix, kSseLoad, 1, slot(index + 1));
+      as_.call(reinterpret_cast<const void *>(&binaryHelper));
+      as_.sse(kScalarPrefix, kSseStore, 0, slot(index));
+    }
+  }
+};
+
+}  // namespace
+#endif  // S21_JIT_X86_64
+
+/// @brief JitProgram constructor, generates native code if supported
+/// @param program compiled program
+JitProgram::JitProgram(const Program &program) : program_(program) {
+#ifdef S21_JIT_X86_64
+  if (program_.isEmpty() || program_.getStackDepth() > kMaxStackDepth) {
+    return;
+  }
+  Assembler assembler;
+  CodeGenerator(program_, false, assembler).generate();
+  std::size_t blockOffset = (assembler.getPosition() + 15) & ~std::size_t{15};
+  assembler.getCode().resize(blockOffset, 0xcc);
+  CodeGenerator(program_, true, assembler).generate();
+  std::vector<std::uint8_t> &code = assembler.getCode();
+
+  void *memory = mmap(nullptr, code.size(), PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED) {
+    return;
+  }
+  std::memcpy(memory, code.data(), code.size());
+  if (mprotect(memory, code.size(), PROT_READ | PROT_EXEC) != 0) {
+    munmap(memory, code.size());
+    return;
+  }
+  code_ = memory;
+  codeSize_ = code.size();
+  scalar_ = reinterpret_cast<ScalarEntry>(code_);
+  block_ = reinterpret_cast<BlockEntry>(static_cast<std::uint8_t *>(code_) +
+                                        blockOffset);
+#endif
+}
+
+/// @brief JitProgram destructor, releases native code
+JitProgram::~JitProgram() {
+#ifdef S21_JIT_X86_64
+  if (code_) {
+    munmap(code_, codeSize_);
+  }
+#endif
+}
+
+/// @brief check if native code generation is available on this platform
+/// @return bool
+bool JitProgram::isSupported() {
+#ifdef S21_JIT_X86_64
+  return true;
+#else
+  return false;
+#endif
+}
+
+/// @brief evaluate for x, see Program::evaluate(x, stack)
+/// @param x x value
+/// @param stack scratch buffer of at least getScratchSize() elements
+/// @return double result
+double JitProgram::evaluate(double x, double *stack) const {
+  if (!scalar_) {
+    return program_.evaluate(x, stack);
+  }
+  return scalar_(x, stack);
+}
+
+/// @brief evaluate for each x, see Program::evaluate(xs, ys)
+/// @param xs x values
+/// @param ys results, same size as xs
+void JitProgram::evaluate(std::span<const double> xs,
+                          std::span<double> ys) const {
+  if (!block_) {
+    program_.evaluate(xs, ys);
+    return;
+  }
+  if (xs.size() != ys.size()) {
+    throw std::logic_error("Batch sizes mismatch");
+  }
+  constexpr std::size_t kBlockSize = Program::kBlockSize;
+  std::vector<double> columns(program_.getScratchSize() * kBlockSize);
+  for (std::size_t i = 0; i < xs.size(); i += kBlockSize) {
+    std::size_t size = std::min(kBlockSize, xs.size() - i);
+    if (size % 2 == 0) {
+      block_(xs.data() + i, ys.data() + i, columns.data(), size);
+    } else {
+      // the native loop takes two values at a time
+      double paddedXs[kBlockSize + 1] = {};
+      double paddedYs[kBlockSize + 1];
+      std::copy_n(xs.data() + i, size, paddedXs);
+      block_(paddedXs, paddedYs, columns.data(), size + 1);
+      std::copy_n(paddedYs, size, ys.data() + i);
+    }
+  }
+}
+
+/// @brief check if native code is used
+/// @return bool
+bool JitProgram::isCompiled() const { return block_ != nullptr; }
+/// @brief get source program
+/// @return const Program&
+const Program &JitProgram::getProgram() const { return program_; }
+
+}  // namespace s21
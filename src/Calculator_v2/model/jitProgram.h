@@ -0,0 +1,54 @@
+#ifndef CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_JITPROGRAM_H_
+#define CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_JITPROGRAM_H_
+
+#include <cstddef>
+#include <span>
+
+#include "program.h"
+
+namespace s21 {
+
+//! Program lowered to native x86-64 code
+/*!
+  Two entry points are generated into executable memory: a scalar one
+  (SSE2 scalar double, same contract as Program::evaluate(x, stack)) and a
+  block one (SSE2 packed double, two x values per iteration). Runs of
+  arithmetic keep the evaluation stack in xmm registers and are fused into a
+  single loop over the block; every other operation calls the same routines
+  as the interpreter, so results are bit-identical to it.
+
+  When native code is not available (other architectures or operating
+  systems, or a stack deeper than the register file) isCompiled() is false
+  and evaluation falls back to the interpreter.
+*/
+class JitProgram {
+ public:
+  explicit JitProgram(const Program &program);
+  JitProgram(const JitProgram &) = delete;
+  JitProgram &operator=(const JitProgram &) = delete;
+  ~JitProgram();
+
+  double evaluate(double x, double *stack) const;
+  void evaluate(std::span<const double> xs, std::span<double> ys) const;
+
+  static bool isSupported();
+
+  // GETTERS
+  bool isCompiled() const;
+  const Program &getProgram() const;
+
+ private:
+  using ScalarEntry = double (*)(double x, double *stack);
+  using BlockEntry = void (*)(const double *xs, double *ys, double *columns,
+                              std::size_t size);
+
+  Program program_;
+  void *code_{nullptr};
+  std::size_t codeSize_{0};
+  ScalarEntry scalar_{nullptr};
+  BlockEntry block_{nullptr};
+};
+
+}  // namespace s21
+
+#endif  // CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_JITPROGRAM_H_
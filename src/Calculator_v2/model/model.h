@@ -1,148 +1,173 @@
 #ifndef CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_MODEL_H_
 #define CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_MODEL_H_
 
+#include <algorithm>
 #include <cmath>
 #include <functional>
-#include <map>
-#include <queue>
-#include <regex>
-#include <stack>
+#include <memory>
 #include <string>
-#include <variant>
+#include <utility>
 #include <vector>
 
-namespace s21 {
-//! Token types
-enum Type {
-  kNumber,
-  kBinaryOperator,
-  kUnaryPrefixOperator,
-  kUnaryPostfixOperator,
-  kUnaryFunction,
-  kOpenBracket,
-  kCloseBracket,
-  kNumTokenType
-};
-//! Token precedence
-enum Precedence { kDefault, kLow, kMedium, kHigh, kUnaryOperator, kFunction };
-//! Operator-tokens / function-tokens associativity
-enum Associativity { kNone, kLeft, kRight };
-
-//! Token class
-class Token {
- public:
-  using unaryFunction = std::function<double(double)>;
-  using binaryFunction = std::function<double(double, double)>;
-  using functionVariant =
-      std::variant<double, unaryFunction, binaryFunction, nullptr_t>;
-
-  Token() = default;
-  Token(const std::string &name, Precedence precedence,
-        Associativity associativity, Type type, functionVariant function);
-  ~Token() = default;
-
-  void makeNumber(std::string name, double value);
-  void makeUnaryNegative();
-
-  // GETTERS
-  std::string getName() const;
-  Type getType() const;
-  Precedence getPrecedence() const;
-  Associativity getAssociativity() const;
-  functionVariant getFunction();
-
- private:
-  std::string name_;
-  Type type_;
-  Precedence precedence_;
-  Associativity associativity_;
-  functionVariant function_;
-};
+#include "budget.h"
+#include "compiledExpression.h"
+#include "dualMath.h"
+#include "expected.h"
+#include "expressionCache.h"
+#include "intervalMath.h"
+#include "jitProgram.h"
+#include "optimizer.h"
+#include "quadrature.h"
+#include "rootFinder.h"
+#include "threadPool.h"
 
+namespace s21 {
 class CalcModel {
  public:
   using GraphXY = std::pair<std::vector<double>, std::vector<double>>;
-  CalcModel();
+  //! Graph points evaluated by one pool task
+  static constexpr std::size_t kChunkSize = 16 * Program::kBlockSize;
+  //! Uniform points adaptive sampling starts from
+  static constexpr std::size_t kAdaptiveInitialPoints = 129;
+  //! Default point budget of adaptive sampling
+  static constexpr std::size_t kAdaptiveMaxPoints = 10000;
+  //! Default max deviation from straight lines, in heights of the y window:
+  //! about a pixel of a 1000 pixels high plot
+  static constexpr double kAdaptiveTolerance = 1e-3;
+  //! Default dense samples per pixel column of graphCalculatePixels()
+  static constexpr std::size_t kSamplesPerPixel = 16;
+  //! Brackets refined by one pool task of criticalPointsCalculate()
+  static constexpr std::size_t kBracketChunkSize = 256;
+  //! Equal segments adaptive integration starts from
+  static constexpr std::size_t kIntegralInitialSegments = 16;
+  //! Default evaluation budget of integralCalculate()
+  static constexpr std::size_t kIntegralMaxEvaluations = 1000000;
+  //! Default integral error, relative to the integral of |f|
+  static constexpr double kIntegralTolerance = 1e-10;
+
+  CalcModel() = default;
   ~CalcModel() = default;
 
-  void modelCalculate(const std::string &expression, double x);
+  CompiledExpression compileExpression(const std::string &expression);
+  Expected<CompiledExpression> tryCompileExpression(
+      const std::string &expression);
+  void modelCalculate(const std::string &expression, double x,
+                      Precision precision = Precision::kLongDouble);
+  Expected<double> tryCalculate(const std::string &expression, double x,
+                                Precision precision = Precision::kLongDouble);
   void graphCalculate(const std::string &expression, double step, double xMax,
-                      double xMin, double yMax, double yMin);
+                      double xMin, double yMax, double yMin,
+                      Precision precision = Precision::kDouble);
+  void modelDifferentiate(const std::string &expression, double x);
+  void graphCalculateDerivative(const std::string &expression, double step,
+                                double xMax, double xMin, double yMax,
+                                double yMin);
+  void graphCalculateAdaptive(const std::string &expression, double xMax,
+                              double xMin, double yMax, double yMin,
+                              std::size_t maxPoints = kAdaptiveMaxPoints,
+                              double tolerance = kAdaptiveTolerance);
+  void graphCalculatePixels(const std::string &expression, double xMax,
+                            double xMin, double yMax, double yMin,
+                            std::size_t width,
+                            std::size_t samplesPerPixel = kSamplesPerPixel,
+                            Precision precision = Precision::kDouble);
+  void criticalPointsCalculate(const std::string &expression, double step,
+                               double xMax, double xMin);
+  void integralCalculate(
+      const std::string &expression, double a, double b,
+      double tolerance = kIntegralTolerance,
+      std::size_t maxEvaluations = kIntegralMaxEvaluations);
+
+  void setCacheCapacity(std::size_t capacity);
+  void setBudget(const Budget &budget);
+  void setThreadCount(std::size_t threads);
+  void setJitEnabled(bool enabled);
+  void setFastMathEnabled(bool enabled);
+  void setIntervalSamplingEnabled(bool enabled);
 
   // GETTERS
   double getResult();
+  double getDerivative() const;
   GraphXY getGraph() const;
+  GraphXY takeGraph();
+  std::vector<CriticalPoint> getCriticalPoints() const;
+  Integral getIntegral() const;
+  Budget getBudget() const;
+  JobStatus getStatus() const;
+  const ExpressionCache &getCache() const;
+  std::size_t getThreadCount() const;
+  bool isJitEnabled() const;
+  bool isFastMathEnabled() const;
+  bool isIntervalSamplingEnabled() const;
+  Optimizer::Report getOptimizerReport() const;
 
  private:
   double resultNum_{NAN};
+  double derivative_{NAN};
   GraphXY graphValues_;
-  std::string expression_;
-  double x_{NAN};
-
-  std::map<std::string, Token> tokenMap_;
-  std::stack<Token> stack_;
-  std::queue<Token> input_;
-  std::queue<Token> output_;
-  std::vector<double> result_;
-
-  void createTokenMap(std::map<std::string, Token> &tokenMap);
-  void parseString(std::string &input);
-  void prepairInput();
-  void checkSequence();
-  void convertInfixToPostfix();
-  double postfixNotationCalculate(double x_val);
+  std::vector<CriticalPoint> criticalPoints_;
+  Integral integral_;
+  ExpressionCache::ProgramPtr program_;
+  ExpressionCache cache_;
+  Optimizer::Report report_;
+  std::size_t threadCount_{0};
+  std::unique_ptr<ThreadPool> pool_;
+  bool jitEnabled_{false};
+  std::unique_ptr<JitProgram> jit_;
+  ExpressionCache::ProgramPtr jitSource_;  //!< program jit_ was built from
+  bool fastMath_{false};
+  bool intervalSampling_{false};
+  Budget budget_;
+  BudgetMeter meter_;
+
+  void compile(const std::string &expression,
+               Precision precision = Precision::kDouble);
+  Expected<ExpressionCache::ProgramPtr> tryCompile(
+      const std::string &expression,
+      Precision precision = Precision::kDouble);
+  double postfixNotationCalculate(double x_val, Precision precision);
+  void evaluatePoints(std::span<const double> xValues,
+                      std::span<double> yValues, Precision precision) const;
+  template <class T>
+  void evaluatePoints(std::span<const double> xValues,
+                      std::span<double> yValues) const;
   void calculateXY(double step, double xMax, double xMin, double yMax,
-                   double yMin);
-  void clearAll();
-
-  // FUNCTION HELPERS
-  std::string toLowerCase(std::string str);
-  std::string readWord(std::string &input, size_t &startIndex) const;
-  std::string readDouble(std::string &input, size_t &startIndex);
-  void pushToken(std::string token);
-  void changeUnaryPlusMinus(std::queue<Token> &input);
-  void moveFromInputToOutput();
-  void moveFromInputToStack();
-  void moveFromStackToOutput();
-  void pushToResult(double function);
-  double popFromResult();
-
-  // ADDINTIONAL FUNCTIONS
-  Token::unaryFunction factorial = [](double num) { return tgammal(num + 1); };
-  Token::unaryFunction percent = [](double num) { return (num / 100); };
-
-  static constexpr bool kAdjacencyMatrix_[kNumTokenType][kNumTokenType] = {
-      {0, 1, 0, 1, 0, 0, 1},  // kNumber
-      {1, 0, 1, 0, 1, 1, 0},  // kBinaryOperator
-      {1, 0, 1, 0, 1, 1, 0},  // kUnaryPrefixOperator
-      {0, 1, 0, 1, 0, 0, 1},  // kUnaryPostfixOperator
-      {0, 0, 0, 0, 0, 1, 0},  // kUnaryFunction
-      {1, 0, 1, 0, 1, 1, 0},  // kOpenBracket
-      {0, 1, 0, 1, 0, 0, 1},  // kCloseBracket
-  };
-  static constexpr bool kFirstToken_[kNumTokenType] = {1, 0, 1, 0, 1, 1, 0};
-  static constexpr bool kLastToken_[kNumTokenType] = {1, 0, 0, 1, 0, 0, 1};
-
-  // check if multiplication is necessary
-  static constexpr bool kMultAddMatrix_[kNumTokenType][kNumTokenType] = {
-      {1, 0, 0, 0, 1, 1, 0},  // kNumber
-      {0, 0, 0, 0, 0, 0, 0},  // kBinaryOperator
-      {0, 0, 0, 0, 0, 0, 0},  // kUnaryPrefixOperator
-      {1, 0, 1, 0, 1, 1, 0},  // kUnaryPostfixOperator
-      {0, 0, 0, 0, 0, 0, 0},  // kUnaryFunction
-      {0, 0, 0, 0, 0, 0, 0},  // kOpenBracket
-      {1, 0, 1, 0, 1, 1, 0},  // kCloseBracket
-  };
-};
-
-// helper type for the visitor
-template <class... Ts>
-struct overloaded : Ts... {
-  using Ts::operator()...;
+                   double yMin, Precision precision);
+  void calculateChunk(std::span<const double> xValues,
+                      std::span<double> yValues, double yMax, double yMin,
+                      Precision precision, std::vector<std::size_t> &poles);
+  std::vector<double> makeGrid(double step, double xMax, double xMin);
+  std::size_t forEachChunk(
+      std::size_t size,
+      const std::function<void(std::size_t, std::size_t)> &task,
+      std::size_t chunkSize = kChunkSize);
+  void calculateDerivativeXY(double step, double xMax, double xMin,
+                             double yMax, double yMin);
+  void calculateCriticalPoints(double step, double xMax, double xMin);
+  void calculateIntegral(double a, double b, double tolerance,
+                         std::size_t maxEvaluations);
+  bool integrateSegments(std::span<Quadrature::Segment> segments);
+  GraphXY evaluateGrid(std::vector<double> xValues, double yMax, double yMin,
+                       Precision precision);
+  void calculatePixels(double xMax, double xMin, double yMax, double yMin,
+                       std::size_t width, std::size_t samplesPerPixel,
+                       Precision precision);
+  static GraphXY decimate(const GraphXY &graph, double xMin, double xMax,
+                          std::size_t width);
+  void calculateAdaptive(double xMax, double xMin, double yMax, double yMin,
+                         std::size_t maxPoints, double tolerance);
+  static void measureBends(const std::vector<double> &xValues,
+                           const std::vector<double> &yValues, double yMax,
+                           double yMin, std::vector<double> &errors);
+  static void insertBreaks(
+      std::vector<double> &xValues, std::vector<double> &yValues,
+      const std::vector<std::vector<std::size_t>> &poles);
+  void evaluateGraphPoints(std::span<const double> xValues,
+                           std::span<double> yValues,
+                           Precision precision) const;
+  ThreadPool &getPool();
+  void prepareJit();
 };
-// explicit deduction guide (not needed as of C++20)
-template <class... Ts>
-overloaded(Ts...) -> overloaded<Ts...>;
 
 }  // namespace s21
 
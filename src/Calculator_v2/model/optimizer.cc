@@ -0,0 +1,561 @@
+#include "optimizer.h"
+
+#include <cmath>
+#include <utility>
+#include <vector>
+
+#include "expressionDag.h"
+
+namespace s21 {
+
+namespace {
+
+// instructions, kPushConst keeps its value instead of pool index, the others
+// keep their operand
+using Code = std::vector<std::pair<OpCode, double>>;
+
+//! Longest exponent lowered to a multiplication chain
+constexpr double kMaxChainExponent = 32;
+//! Highest degree of a polynomial rewritten to Horner form
+constexpr std::size_t kMaxDegree = 32;
+
+Program build(const Code &code) {
+  Program::Builder builder;
+  for (const auto &[opCode, value] : code) {
+    if (opCode == OpCode::kPushConst) {
+      builder.pushConstant(value);
+    } else {
+      builder.pushOperation(opCode, static_cast<std::uint32_t>(value));
+    }
+  }
+  return builder.build();
+}
+
+// no temporaries and superinstructions, code is a plain postfix tree
+bool isTree(const Program &program) {
+  for (const Instruction &instruction : program.getCode()) {
+    if (instruction.code > OpCode::kPercent) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// single instruction pushing a value without side effects
+bool isPush(OpCode code) {
+  return code == OpCode::kPushConst || code == OpCode::kPushX ||
+         code == OpCode::kLoad;
+}
+
+OpCode withX(OpCode code) {
+  switch (code) {
+    case OpCode::kAdd:
+      return OpCode::kAddX;
+    case OpCode::kSub:
+      return OpCode::kSubX;
+    case OpCode::kMul:
+      return OpCode::kMulX;
+    case OpCode::kDiv:
+      return OpCode::kDivX;
+    default:
+      return OpCode::kNop;
+  }
+}
+
+void append(Code &code, const Code &tail) {
+  code.insert(code.end(), tail.begin(), tail.end());
+}
+
+// integer exponent of e ^ n if n is a single constant
+bool isIntegerConstant(const Code &code, double &value) {
+  if (code.size() != 1 || code[0].first != OpCode::kPushConst) {
+    return false;
+  }
+  value = code[0].second;
+  return std::trunc(value) == value;
+}
+
+// e ^ n as squarings and multiplications of copies of e, merged later by
+// common subexpression elimination
+Code multiplicationChain(const Code &base, long exponent) {
+  if (exponent == 1) {
+    return base;
+  }
+  Code code = multiplicationChain(base, exponent / 2);
+  Code half = code;
+  append(code, half);
+  code.emplace_back(OpCode::kMul, 0.0);
+  if (exponent % 2 != 0) {
+    append(code, base);
+    code.emplace_back(OpCode::kMul, 0.0);
+  }
+  return code;
+}
+
+//! Stack entry of the polynomial pass
+struct Term {
+  Code code;
+  std::vector<double> coefficients;  //!< from degree 0, empty if not in x
+  bool isMonomial{false};
+  std::vector<char> written;  //!< degrees with a term in the written form
+  bool hasZeroTerm{false};    //!< a written term 0 * x ^ k, k > 0
+
+  bool isPolynomial() const { return !coefficients.empty(); }
+  bool isConstant() const { return isMonomial && coefficients.size() == 1; }
+};
+
+Code horner(const std::vector<double> &coefficients) {
+  Code code{{OpCode::kPushConst, coefficients.back()}};
+  for (std::size_t i = coefficients.size() - 1; i-- > 0;) {
+    code.emplace_back(OpCode::kPushX, 0.0);
+    code.emplace_back(OpCode::kMul, 0.0);
+    // + 0 keeps a zero result +0: written sums of nonzero terms are never -0
+    if (coefficients[i] != 0.0 || i == 0) {
+      code.emplace_back(OpCode::kPushConst, coefficients[i]);
+      code.emplace_back(OpCode::kAdd, 0.0);
+    }
+  }
+  return code;
+}
+
+// Horner form evaluates like the written one: merged coefficients did not
+// overflow, and no written term was 0 or cancelled, 0 * inf is NaN
+bool isExact(const Term &term) {
+  if (term.hasZeroTerm) {
+    return false;
+  }
+  for (std::size_t i = 0; i < term.coefficients.size(); ++i) {
+    if (!std::isfinite(term.coefficients[i]) ||
+        (term.written[i] && term.coefficients[i] == 0.0)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// rewrite a sum of monomials of degree 2 or more, stop tracking the term
+void finish(Term &term, std::size_t &rewritten) {
+  if (!term.isMonomial && term.coefficients.size() > 2 &&
+      term.coefficients.back() != 0.0 && isExact(term)) {
+    term.code = horner(term.coefficients);
+    ++rewritten;
+  }
+  term.coefficients.clear();
+  term.written.clear();
+}
+
+std::vector<double> product(const std::vector<double> &lhs,
+                            const std::vector<double> &rhs) {
+  std::vector<double> result(lhs.size() + rhs.size() - 1, 0.0);
+  for (std::size_t i = 0; i < lhs.size(); ++i) {
+    for (std::size_t j = 0; j < rhs.size(); ++j) {
+      result[i + j] += lhs[i] * rhs[j];
+    }
+  }
+  return result;
+}
+
+// written degrees of the product of two polynomials
+std::vector<char> productDegrees(const std::vector<char> &lhs,
+                                 const std::vector<char> &rhs) {
+  std::vector<char> result(lhs.size() + rhs.size() - 1, false);
+  for (std::size_t i = 0; i < lhs.size(); ++i) {
+    for (std::size_t j = 0; j < rhs.size(); ++j) {
+      result[i + j] = result[i + j] || (lhs[i] && rhs[j]);
+    }
+  }
+  return result;
+}
+
+// polynomial form of lhs op rhs, empty if it is not tracked
+Term combine(OpCode code, const Term &lhs, const Term &rhs) {
+  Term result;
+  if (!lhs.isPolynomial() || !rhs.isPolynomial()) {
+    return result;
+  }
+  if (code == OpCode::kAdd || code == OpCode::kSub) {
+    result.coefficients.resize(
+        std::max(lhs.coefficients.size(), rhs.coefficients.size()), 0.0);
+    result.written.resize(result.coefficients.size(), false);
+    for (std::size_t i = 0; i < lhs.coefficients.size(); ++i) {
+      result.coefficients[i] += lhs.coefficients[i];
+      result.written[i] = lhs.written[i];
+    }
+    for (std::size_t i = 0; i < rhs.coefficients.size(); ++i) {
+      result.coefficients[i] += code == OpCode::kAdd ? rhs.coefficients[i]
+                                                     : -rhs.coefficients[i];
+      result.written[i] = result.written[i] || rhs.written[i];
+    }
+  } else if (code == OpCode::kMul &&
+             ((lhs.isMonomial && rhs.isMonomial) || lhs.isConstant() ||
+              rhs.isConstant()) &&
+             lhs.coefficients.size() + rhs.coefficients.size() - 2 <=
+                 kMaxDegree) {
+    // no expansion of products of sums, it loses precision near the roots
+    result.coefficients = product(lhs.coefficients, rhs.coefficients);
+    result.written = productDegrees(lhs.written, rhs.written);
+    result.isMonomial = lhs.isMonomial && rhs.isMonomial;
+  } else if (code == OpCode::kPow && lhs.isMonomial) {
+    double exponent = 0;
+    if (isIntegerConstant(rhs.code, exponent) && exponent >= 0 &&
+        (lhs.coefficients.size() - 1) * exponent <= kMaxDegree) {
+      result.coefficients = {1.0};
+      result.written = {true};
+      for (int i = 0; i < exponent; ++i) {
+        result.coefficients = product(result.coefficients, lhs.coefficients);
+        result.written = productDegrees(result.written, lhs.written);
+      }
+      result.isMonomial = true;
+    }
+  }
+  result.hasZeroTerm = lhs.hasZeroTerm || rhs.hasZeroTerm;
+  for (std::size_t i = 1; result.isMonomial && i < result.written.size();
+       ++i) {
+    if (result.written[i] && result.coefficients[i] == 0.0) {
+      result.hasZeroTerm = true;
+    }
+  }
+  return result;
+}
+
+//! Sum of code and a constant term collected by relaxPrecision(), code is
+//! empty for a constant
+struct Sum {
+  Code code;
+  double constant;
+
+  Code materialize() const {
+    Code result = code;
+    if (result.empty() || constant != 0) {
+      result.emplace_back(OpCode::kPushConst, constant);
+      if (!code.empty()) {
+        result.emplace_back(OpCode::kAdd, 0.0);
+      }
+    }
+    return result;
+  }
+};
+
+// value of an operation on constants as the evaluator of precision computes
+// it, long double evaluation rounds every result to double
+double fold(OpCode code, double lArg, double rArg, Precision precision) {
+  int arity = Program::getArity(code);
+  if (precision == Precision::kLongDouble) {
+    return static_cast<double>(
+        arity == 1 ? Program::applyUnary<long double>(code, lArg)
+                   : Program::applyBinary<long double>(code, lArg, rArg));
+  }
+  return arity == 1 ? Program::applyUnary(code, lArg)
+                    : Program::applyBinary(code, lArg, rArg);
+}
+
+// fast math replacement of unary operation
+OpCode approximation(OpCode code) {
+  switch (code) {
+    case OpCode::kSin:
+      return OpCode::kFastSin;
+    case OpCode::kCos:
+      return OpCode::kFastCos;
+    default:
+      return code;
+  }
+}
+
+}  // namespace
+
+/// @brief run all passes
+/// @param program compiled program
+/// @param report filled with pass statistics if not null
+/// @param mode kFast adds relaxPrecision()
+/// @param precision scalar type the program is evaluated in
+/// @return optimized program
+Program Optimizer::optimize(const Program &program, Report *report,
+                            Mode mode, Precision precision) {
+  Report stats;
+  stats.instructionsBefore = program.getSize();
+  Program result = foldConstants(program, precision);
+  result = hornerPolynomials(result, &stats.polynomials);
+  result = expandPowers(result, &stats.powers);
+  if (mode == Mode::kFast) {
+    result = relaxPrecision(result, &stats.relaxed);
+  }
+  ExpressionDag dag(result);
+  stats.deduplicatedNodes = dag.getDeduplicatedCount();
+  result = dag.toProgram();
+  std::size_t fused = 0;
+  result = fuseInstructions(result, &fused);
+  stats.fusedInstructions = fused + dag.getFusedCount();
+  stats.instructionsAfter = result.getSize();
+  if (report) {
+    *report = stats;
+  }
+  return result;
+}
+
+/// @brief replace every subtree that does not depend on x with its value,
+/// computed by the same scalar routines as the evaluator
+/// @param program compiled program
+/// @param precision scalar type the program is evaluated in, kLongDouble
+/// folds with the long double routines rounded to double like its evaluation
+/// @return folded program
+Program Optimizer::foldConstants(const Program &program,
+                                 Precision precision) {
+  Code code;
+  std::vector<bool> isConstant;  // per evaluation stack slot
+  for (const Instruction &instruction : program.getCode()) {
+    int arity = Program::getArity(instruction.code);
+    if (instruction.code == OpCode::kPushConst) {
+      code.emplace_back(OpCode::kPushConst,
+                        program.getConstant(instruction.operand));
+      isConstant.push_back(true);
+    } else if (arity == 0) {
+      code.emplace_back(instruction.code, instruction.operand);
+      isConstant.push_back(false);
+    } else if (instruction.code > OpCode::kPercent) {
+      // stores and superinstructions are not folded
+      code.emplace_back(instruction.code, instruction.operand);
+      isConstant.resize(isConstant.size() - arity + 1);
+      isConstant.back() = false;
+    } else if (arity == 1 && isConstant.back()) {
+      code.back().second =
+          fold(instruction.code, code.back().second, 0.0, precision);
+    } else if (arity == 2 && isConstant.back() &&
+               isConstant[isConstant.size() - 2]) {
+      double rArg = code.back().second;
+      code.pop_back();
+      code.back().second =
+          fold(instruction.code, code.back().second, rArg, precision);
+      isConstant.pop_back();
+    } else {
+      code.emplace_back(instruction.code, instruction.operand);
+      isConstant.resize(isConstant.size() - arity + 1);
+      isConstant.back() = false;
+    }
+  }
+  return build(code);
+}
+
+/// @brief lower e ^ n with a constant integer 0 < |n| <= kMaxChainExponent
+/// to multiplications (and a division for n < 0) instead of pow
+/// @param program compiled program without temporaries and superinstructions
+/// @param expanded set to the number of lowered powers if not null
+/// @return program
+Program Optimizer::expandPowers(const Program &program,
+                                std::size_t *expanded) {
+  if (!isTree(program)) {
+    return program;
+  }
+  std::size_t count = 0;
+  std::vector<Code> stack;  // code of each evaluation stack slot
+  for (const Instruction &instruction : program.getCode()) {
+    int arity = Program::getArity(instruction.code);
+    double exponent = 0;
+    if (instruction.code == OpCode::kPushConst) {
+      stack.push_back(
+          {{OpCode::kPushConst, program.getConstant(instruction.operand)}});
+    } else if (arity == 0) {
+      stack.push_back({{instruction.code, instruction.operand}});
+    } else if (arity == 1) {
+      stack.back().emplace_back(instruction.code, instruction.operand);
+    } else if (instruction.code == OpCode::kPow &&
+               isIntegerConstant(stack.back(), exponent) && exponent != 0 &&
+               std::fabs(exponent) <= kMaxChainExponent) {
+      stack.pop_back();
+      Code chain = multiplicationChain(
+          stack.back(), static_cast<long>(std::fabs(exponent)));
+      if (exponent < 0) {
+        stack.back() = {{OpCode::kPushConst, 1.0}};
+        append(stack.back(), chain);
+        stack.back().emplace_back(OpCode::kDiv, 0.0);
+      } else {
+        stack.back() = std::move(chain);
+      }
+      ++count;
+    } else {
+      Code rhs = std::move(stack.back());
+      stack.pop_back();
+      append(stack.back(), rhs);
+      stack.back().emplace_back(instruction.code, instruction.operand);
+    }
+  }
+  if (expanded) {
+    *expanded = count;
+  }
+  return count == 0 ? program : build(stack.back());
+}
+
+/// @brief rewrite sums of monomials c * x ^ k of degree 2 or more to Horner
+/// form, products of sums are not expanded, sums whose merged coefficients
+/// overflow or whose written terms cancel are kept
+/// @param program compiled program without temporaries and superinstructions
+/// @param rewritten set to the number of rewritten polynomials if not null
+/// @return program
+Program Optimizer::hornerPolynomials(const Program &program,
+                                     std::size_t *rewritten) {
+  if (!isTree(program)) {
+    return program;
+  }
+  std::size_t count = 0;
+  std::vector<Term> stack;
+  for (const Instruction &instruction : program.getCode()) {
+    int arity = Program::getArity(instruction.code);
+    if (instruction.code == OpCode::kPushConst) {
+      double value = program.getConstant(instruction.operand);
+      stack.push_back({{{OpCode::kPushConst, value}}, {value}, true, {true}});
+    } else if (instruction.code == OpCode::kPushX) {
+      stack.push_back(
+          {{{OpCode::kPushX, 0.0}}, {0.0, 1.0}, true, {false, true}});
+    } else if (arity == 0) {
+      stack.push_back(
+          {{{instruction.code, instruction.operand}}, {}, false, {}});
+    } else if (arity == 1) {
+      Term &term = stack.back();
+      if (instruction.code == OpCode::kNegate && term.isPolynomial()) {
+        for (double &coefficient : term.coefficients) {
+          coefficient = -coefficient;
+        }
+      } else {
+        finish(term, count);
+      }
+      term.code.emplace_back(instruction.code, instruction.operand);
+    } else {
+      Term rhs = std::move(stack.back());
+      stack.pop_back();
+      Term &lhs = stack.back();
+      Term result = combine(instruction.code, lhs, rhs);
+      if (!result.isPolynomial()) {
+        finish(lhs, count);
+        finish(rhs, count);
+      }
+      result.code = std::move(lhs.code);
+      append(result.code, rhs.code);
+      result.code.emplace_back(instruction.code, instruction.operand);
+      lhs = std::move(result);
+    }
+  }
+  finish(stack.back(), count);
+  if (rewritten) {
+    *rewritten = count;
+  }
+  return count == 0 ? program : build(stack.back().code);
+}
+
+/// @brief merge instruction pairs into superinstructions: "* push +" to
+/// push and kMulAdd, "push x, op" to kAddX, kSubX, kMulX or kDivX and
+/// "kMulX push +" (a Horner step) to push and kMulXAdd
+/// @param program compiled program
+/// @param fused set to the number of removed instructions if not null
+/// @return program
+Program Optimizer::fuseInstructions(const Program &program,
+                                    std::size_t *fused) {
+  Code code;
+  for (const Instruction &instruction : program.getCode()) {
+    std::size_t size = code.size();
+    if (instruction.code == OpCode::kPushConst) {
+      code.emplace_back(OpCode::kPushConst,
+                        program.getConstant(instruction.operand));
+    } else if (instruction.code == OpCode::kAdd && size >= 2 &&
+               (code[size - 2].first == OpCode::kMul ||
+                code[size - 2].first == OpCode::kMulX) &&
+               isPush(code[size - 1].first)) {
+      OpCode fused = code[size - 2].first == OpCode::kMul ? OpCode::kMulAdd
+                                                          : OpCode::kMulXAdd;
+      code[size - 2] = code[size - 1];
+      code[size - 1] = {fused, 0.0};
+    } else if (withX(instruction.code) != OpCode::kNop && size >= 1 &&
+               code[size - 1].first == OpCode::kPushX) {
+      code[size - 1] = {withX(instruction.code), 0.0};
+    } else {
+      code.emplace_back(instruction.code, instruction.operand);
+    }
+  }
+  if (fused) {
+    *fused = program.getSize() - code.size();
+  }
+  return build(code);
+}
+
+/// @brief fast math rewrites: e / c to e * (1 / c), constant terms of sums
+/// moved to the end and added once, sin and cos to kFastSin and kFastCos
+/// @param program compiled program without temporaries and superinstructions
+/// @param relaxed set to the number of rewrites if not null
+/// @return program
+Program Optimizer::relaxPrecision(const Program &program,
+                                  std::size_t *relaxed) {
+  if (!isTree(program)) {
+    return program;
+  }
+  std::size_t count = 0;
+  std::vector<Sum> stack;
+  for (const Instruction &instruction : program.getCode()) {
+    int arity = Program::getArity(instruction.code);
+    if (instruction.code == OpCode::kPushConst) {
+      stack.push_back({{}, program.getConstant(instruction.operand)});
+    } else if (arity == 0) {
+      stack.push_back({{{instruction.code, instruction.operand}}, 0.0});
+    } else if (instruction.code == OpCode::kNegate) {
+      Sum &sum = stack.back();
+      if (!sum.code.empty()) {
+        sum.code.emplace_back(OpCode::kNegate, 0.0);
+      }
+      sum.constant = -sum.constant;
+    } else if (arity == 1) {
+      OpCode code = approximation(instruction.code);
+      count += code != instruction.code;
+      Sum &sum = stack.back();
+      sum.code = sum.materialize();
+      sum.code.emplace_back(code, instruction.operand);
+      sum.constant = 0.0;
+    } else {
+      Sum rhs = std::move(stack.back());
+      stack.pop_back();
+      Sum &lhs = stack.back();
+      OpCode code = instruction.code;
+      if (code == OpCode::kAdd || code == OpCode::kSub) {
+        bool subtract = code == OpCode::kSub;
+        count += lhs.constant != 0 && rhs.constant != 0;
+        if (lhs.code.empty()) {
+          lhs.code = std::move(rhs.code);
+          if (subtract && !lhs.code.empty()) {
+            lhs.code.emplace_back(OpCode::kNegate, 0.0);
+          }
+        } else if (!rhs.code.empty()) {
+          append(lhs.code, rhs.code);
+          lhs.code.emplace_back(code, 0.0);
+        }
+        lhs.constant = subtract ? lhs.constant - rhs.constant
+                                : lhs.constant + rhs.constant;
+        continue;
+      }
+      if (code == OpCode::kDiv && rhs.code.empty() &&
+          std::isfinite(1.0 / rhs.constant) && rhs.constant != 0) {
+        rhs.constant = 1.0 / rhs.constant;
+        code = OpCode::kMul;
+        ++count;
+      }
+      lhs.code = lhs.materialize();
+      append(lhs.code, rhs.materialize());
+      lhs.code.emplace_back(code, instruction.operand);
+      lhs.constant = 0.0;
+    }
+  }
+  if (relaxed) {
+    *relaxed = count;
+  }
+  return count == 0 ? program : build(stack.back().materialize());
+}
+
+/// @brief compute every repeated subexpression once, see ExpressionDag
+/// @param program compiled program
+/// @param deduplicated set to the number of merged nodes if not null
+/// @return program with temporaries for shared subexpressions
+Program Optimizer::eliminateCommonSubexpressions(const Program &program,
+                                                 std::size_t *deduplicated) {
+  ExpressionDag dag(program);
+  if (deduplicated) {
+    *deduplicated = dag.getDeduplicatedCount();
+  }
+  return dag.toProgram();
+}
+
+}  // namespace s21
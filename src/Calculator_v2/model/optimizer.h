@@ -0,0 +1,66 @@
+#ifndef CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_OPTIMIZER_H_
+#define CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_OPTIMIZER_H_
+
+#include <cstddef>
+
+#include "program.h"
+
+namespace s21 {
+
+//! Compile passes over bytecode programs
+/*!
+  Every pass returns a new program computing the same function of x, NaN
+  and infinity propagation included, with these exceptions:
+  expandPowers() and hornerPolynomials() reorder arithmetic and
+  fuseInstructions() rounds a * b + c once, so their results may differ
+  from pow and the written form in the last bits. At x = +-inf a polynomial
+  in Horner form is infinite where the written terms of opposite signs give
+  inf - inf = NaN, e.g. x^2 + x at -inf. Its zero results are +0, also
+  where all written terms are -0, e.g. -x^2 - x at 0.
+
+  foldConstants() computes with the routines of the evaluation precision:
+  long double programs round every result to double like the constants, so
+  x / 3 + 1 / 3 at x = -1 is 0 whether 1 / 3 is folded or not.
+
+  relaxPrecision() runs only in Mode::kFast and trades accuracy for speed:
+  divisions by constants become multiplications by the reciprocal, constant
+  terms of sums are collected into one and sin and cos are replaced with the
+  FastMath approximations. ln stays exact: the vector ln polynomial was 7%
+  faster than the exact kernel for 2 ulp more error.
+*/
+class Optimizer {
+ public:
+  //! Evaluation mode of the optimized program
+  enum class Mode { kExact, kFast };
+
+  //! Statistics of optimize()
+  struct Report {
+    std::size_t deduplicatedNodes{0};  //!< merged repeated subexpressions
+    std::size_t powers{0};       //!< powers lowered to multiplications
+    std::size_t polynomials{0};  //!< polynomials rewritten to Horner form
+    std::size_t fusedInstructions{0};   //!< saved by superinstructions
+    std::size_t instructionsBefore{0};  //!< size of the source program
+    std::size_t instructionsAfter{0};   //!< size of the optimized program
+    std::size_t relaxed{0};  //!< fast math rewrites
+  };
+
+  static Program optimize(const Program &program, Report *report = nullptr,
+                          Mode mode = Mode::kExact,
+                          Precision precision = Precision::kDouble);
+  static Program foldConstants(const Program &program,
+                               Precision precision = Precision::kDouble);
+  static Program expandPowers(const Program &program,
+                              std::size_t *expanded = nullptr);
+  static Program hornerPolynomials(const Program &program,
+                                   std::size_t *rewritten = nullptr);
+  static Program fuseInstructions(const Program &program,
+                                 std::size_t *fused = nullptr);
+  static Program relaxPrecision(const Program &program,
+                                std::size_t *relaxed = nullptr);
+  static Program eliminateCommonSubexpressions(
+      const Program &program, std::size_t *deduplicated = nullptr);
+};
+
+}  // namespace s21
+
+#endif  // CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_OPTIMIZER_H_
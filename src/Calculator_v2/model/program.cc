@@ -0,0 +1,558 @@
+#include "program.h"
+
+#include <type_traits>
+
+#include "fastMath.h"
+#include "vectorMath.h"
+
+namespace s21 {
+
+/******************************************************************************
+ *                                                                            *
+ *                           Program::Builder class                           *
+ *                                                                            *
+ ******************************************************************************/
+
+/// @brief append constant to the pool and emit push instruction
+/// @param value constant value
+void Program::Builder::pushConstant(double value) {
+  code_.push_back(
+      {OpCode::kPushConst, static_cast<std::uint32_t>(constants_.size())});
+  constants_.push_back(value);
+  maxDepth_ = std::max(maxDepth_, ++depth_);
+}
+
+/// @brief emit operation, check stack balance
+/// @param code operation code
+/// @param operand temporary index for kStore, kLoad and sincos instructions
+void Program::Builder::pushOperation(OpCode code, std::uint32_t operand) {
+  if (code == OpCode::kNop) {
+    return;
+  }
+  if (code == OpCode::kPushConst) {
+    throw std::logic_error("Constant without value");
+  }
+  int arity = getArity(code);
+  if (depth_ < static_cast<std::size_t>(arity)) {
+    throw std::logic_error("Not enough operands");
+  }
+  if (code == OpCode::kStore || getSinCosParts(code).first != OpCode::kNop) {
+    temporaries_ = std::max<std::size_t>(temporaries_, operand + 1);
+  } else if (code == OpCode::kLoad && operand >= temporaries_) {
+    throw std::logic_error("Load before store");
+  }
+  depth_ = depth_ - arity + 1;
+  maxDepth_ = std::max(maxDepth_, depth_);
+  code_.push_back({code, operand});
+}
+
+/// @brief finish building
+/// @return immutable program
+Program Program::Builder::build() {
+  if (depth_ != 1) {
+    throw std::logic_error("Invalid expression");
+  }
+  Program program;
+  program.code_ = std::move(code_);
+  program.constants_ = std::move(constants_);
+  program.stackDepth_ = maxDepth_;
+  program.temporaries_ = temporaries_;
+  *this = Builder();
+  return program;
+}
+
+/******************************************************************************
+ *                                                                            *
+ *                               Program class                                *
+ *                                                                            *
+ ******************************************************************************/
+
+/// @brief get number of operands for operation
+/// @param code operation code
+/// @return 0, 1, 2 or 3
+int Program::getArity(OpCode code) {
+  switch (code) {
+    case OpCode::kNop:
+    case OpCode::kPushConst:
+    case OpCode::kPushX:
+    case OpCode::kLoad:
+      return 0;
+    case OpCode::kAdd:
+    case OpCode::kSub:
+    case OpCode::kMul:
+    case OpCode::kDiv:
+    case OpCode::kPow:
+    case OpCode::kMod:
+    case OpCode::kMulXAdd:
+      return 2;
+    case OpCode::kMulAdd:
+      return 3;
+    default:
+      return 1;
+  }
+}
+
+/// @brief calculate unary operation in T
+/// @param code operation code
+/// @param arg argument
+/// @return T
+template <class T>
+T Program::applyUnary(OpCode code, T arg) {
+  switch (code) {
+    case OpCode::kNegate:
+      return -arg;
+    case OpCode::kCos:
+      return std::cos(arg);
+    case OpCode::kSin:
+      return std::sin(arg);
+    case OpCode::kTan:
+      return std::tan(arg);
+    case OpCode::kAcos:
+      return std::acos(arg);
+    case OpCode::kAsin:
+      return std::asin(arg);
+    case OpCode::kAtan:
+      return std::atan(arg);
+    case OpCode::kLn:
+      return std::log(arg);
+    case OpCode::kLog:
+      return std::log10(arg);
+    case OpCode::kSqrt:
+      return std::sqrt(arg);
+    case OpCode::kFactorial:
+      return std::tgamma(arg + 1);
+    case OpCode::kPercent:
+      return arg / 100;
+    case OpCode::kFastSin:
+      return static_cast<T>(FastMath::sin(static_cast<double>(arg)));
+    case OpCode::kFastCos:
+      return static_cast<T>(FastMath::cos(static_cast<double>(arg)));
+    default:
+      return NAN;
+  }
+}
+
+/// @brief calculate binary operation in T
+/// @param code operation code
+/// @param lArg left argument
+/// @param rArg right argument
+/// @return T
+template <class T>
+T Program::applyBinary(OpCode code, T lArg, T rArg) {
+  switch (code) {
+    case OpCode::kAdd:
+      return lArg + rArg;
+    case OpCode::kSub:
+      return lArg - rArg;
+    case OpCode::kMul:
+      return lArg * rArg;
+    case OpCode::kDiv:
+      return lArg / rArg;
+    case OpCode::kPow:
+      return std::pow(lArg, rArg);
+    case OpCode::kMod:
+      return std::fmod(lArg, rArg);
+    default:
+      return NAN;
+  }
+}
+
+namespace {
+
+/// @brief round a result to double in long double evaluation, like the
+/// constants and the folded values
+/// @param value result
+/// @return T
+template <class T>
+T rounded(T value) {
+  if constexpr (std::is_same_v<T, long double>) {
+    return static_cast<double>(value);
+  }
+  return value;
+}
+
+}  // namespace
+
+/// @brief evaluate program for x in T
+/// @param x x value
+/// @param stack scratch buffer of at least getScratchSize() elements
+/// @return T result
+template <class T>
+T Program::evaluate(T x, T *stack) const {
+  T *top = stack;
+  T *temporaries = stack + stackDepth_;
+  for (const Instruction &instruction : code_) {
+    switch (instruction.code) {
+      case OpCode::kPushConst:
+        *top++ = static_cast<T>(constants_[instruction.operand]);
+        break;
+      case OpCode::kPushX:
+        *top++ = x;
+        break;
+      case OpCode::kStore:
+        temporaries[instruction.operand] = top[-1];
+        break;
+      case OpCode::kLoad:
+        *top++ = temporaries[instruction.operand];
+        break;
+      case OpCode::kAdd:
+        --top;
+        top[-1] += top[0];
+        break;
+      case OpCode::kSub:
+        --top;
+        top[-1] -= top[0];
+        break;
+      case OpCode::kMul:
+        --top;
+        top[-1] *= top[0];
+        break;
+      case OpCode::kDiv:
+        --top;
+        top[-1] /= top[0];
+        break;
+      case OpCode::kPow:
+      case OpCode::kMod:
+        --top;
+        top[-1] = applyBinary(instruction.code, top[-1], top[0]);
+        break;
+      case OpCode::kAddX:
+        top[-1] += x;
+        break;
+      case OpCode::kSubX:
+        top[-1] -= x;
+        break;
+      case OpCode::kMulX:
+        top[-1] *= x;
+        break;
+      case OpCode::kDivX:
+        top[-1] /= x;
+        break;
+      case OpCode::kMulAdd:
+        top -= 2;
+        top[-1] = std::fma(top[-1], top[0], top[1]);
+        break;
+      case OpCode::kMulXAdd:
+        --top;
+        top[-1] = std::fma(top[-1], x, top[0]);
+        break;
+      case OpCode::kSinCos:
+      case OpCode::kCosSin:
+      case OpCode::kFastSinCos:
+      case OpCode::kFastCosSin: {
+        auto [first, second] = getSinCosParts(instruction.code);
+        temporaries[instruction.operand] =
+            rounded(applyUnary(second, top[-1]));
+        top[-1] = applyUnary(first, top[-1]);
+        break;
+      }
+      default:
+        top[-1] = applyUnary(instruction.code, top[-1]);
+        break;
+    }
+    top[-1] = rounded(top[-1]);
+  }
+  return stack[0];
+}
+
+template float Program::evaluate(float x, float *stack) const;
+template double Program::evaluate(double x, double *stack) const;
+template long double Program::evaluate(long double x,
+                                       long double *stack) const;
+template float Program::applyUnary(OpCode code, float arg);
+template double Program::applyUnary(OpCode code, double arg);
+template long double Program::applyUnary(OpCode code, long double arg);
+template float Program::applyBinary(OpCode code, float lArg, float rArg);
+template double Program::applyBinary(OpCode code, double lArg, double rArg);
+template long double Program::applyBinary(OpCode code, long double lArg,
+                                          long double rArg);
+
+/// @brief evaluate program column-wise for each x
+/// @param xs x values
+/// @param ys results, same size as xs
+void Program::evaluate(std::span<const double> xs,
+                       std::span<double> ys) const {
+  std::vector<double> columns(getScratchSize() * kBlockSize);
+  evaluate(xs, ys, columns.data());
+}
+
+/// @brief evaluate program column-wise for each x without allocation
+/// @param xs x values
+/// @param ys results, same size as xs
+/// @param columns scratch of at least getScratchSize() * kBlockSize elements
+void Program::evaluate(std::span<const double> xs, std::span<double> ys,
+                       double *columns) const {
+  if (xs.size() != ys.size()) {
+    throw std::logic_error("Batch sizes mismatch");
+  }
+  for (std::size_t i = 0; i < xs.size(); i += kBlockSize) {
+    std::size_t size = std::min(kBlockSize, xs.size() - i);
+    evaluateBlock(xs.data() + i, ys.data() + i, size, columns);
+  }
+}
+
+/// @brief evaluate program column-wise for each x while the budget lasts
+/// @param xs x values
+/// @param ys results, same size as xs
+/// @param meter started budget of the job
+/// @return std::size_t number of leading ys evaluated
+std::size_t Program::evaluate(std::span<const double> xs,
+                              std::span<double> ys, BudgetMeter &meter) const {
+  std::vector<double> columns(getScratchSize() * kBlockSize);
+  return evaluate(xs, ys, columns.data(), meter);
+}
+
+/// @brief evaluate program column-wise for each x while the budget lasts,
+/// without allocation
+/// @param xs x values
+/// @param ys results, same size as xs
+/// @param columns scratch of at least getScratchSize() * kBlockSize elements
+/// @param meter started budget of the job, asked before each block, its
+/// point budget caps the number of x values
+/// @return std::size_t number of leading ys evaluated, a multiple of
+/// kBlockSize if proceed() stopped the job
+std::size_t Program::evaluate(std::span<const double> xs,
+                              std::span<double> ys, double *columns,
+                              BudgetMeter &meter) const {
+  if (xs.size() != ys.size()) {
+    throw std::logic_error("Batch sizes mismatch");
+  }
+  std::size_t points = meter.limitPoints(xs.size());
+  std::size_t i = 0;
+  for (; i < points && meter.proceed(); i += kBlockSize) {
+    std::size_t size = std::min(kBlockSize, points - i);
+    evaluateBlock(xs.data() + i, ys.data() + i, size, columns);
+  }
+  return std::min(i, points);
+}
+
+/// @brief evaluate program for one block of x values
+/// @param xs x values
+/// @param ys results
+/// @param size block size, not greater than kBlockSize
+/// @param columns scratch of getScratchSize() columns
+void Program::evaluateBlock(const double *xs, double *ys, std::size_t size,
+                            double *columns) const {
+  double *top = columns;
+  double *temporaries = columns + stackDepth_ * kBlockSize;
+  for (const Instruction &instruction : code_) {
+    switch (instruction.code) {
+      case OpCode::kStore:
+        std::copy_n(top - kBlockSize, size,
+                    temporaries + instruction.operand * kBlockSize);
+        break;
+      case OpCode::kLoad:
+        std::copy_n(temporaries + instruction.operand * kBlockSize, size, top);
+        top += kBlockSize;
+        break;
+      case OpCode::kPushConst:
+        std::fill_n(top, size, constants_[instruction.operand]);
+        top += kBlockSize;
+        break;
+      case OpCode::kPushX:
+        std::copy_n(xs, size, top);
+        top += kBlockSize;
+        break;
+      case OpCode::kAddX:
+      case OpCode::kSubX:
+      case OpCode::kMulX:
+      case OpCode::kDivX:
+        applyBinary(getBaseOperation(instruction.code), top - kBlockSize, xs,
+                    size);
+        break;
+      case OpCode::kMulAdd:
+        top -= 2 * kBlockSize;
+        applyMulAdd(top - kBlockSize, top, top + kBlockSize, size);
+        break;
+      case OpCode::kMulXAdd:
+        top -= kBlockSize;
+        applyMulAdd(top - kBlockSize, xs, top, size);
+        break;
+      case OpCode::kSinCos:
+      case OpCode::kCosSin:
+      case OpCode::kFastSinCos:
+      case OpCode::kFastCosSin:
+        applySinCos(instruction.code, top - kBlockSize,
+                    temporaries + instruction.operand * kBlockSize, size);
+        break;
+      default:
+        if (getArity(instruction.code) == 2) {
+          top -= kBlockSize;
+          applyBinary(instruction.code, top - kBlockSize, top, size);
+        } else {
+          applyUnary(instruction.code, top - kBlockSize, size);
+        }
+        break;
+    }
+  }
+  std::copy_n(columns, size, ys);
+}
+
+/// @brief apply unary operation to a column
+/// @param code operation code
+/// @param column values, replaced by results
+/// @param size column size
+void Program::applyUnary(OpCode code, double *column, std::size_t size) {
+  switch (code) {
+    case OpCode::kNegate:
+      for (std::size_t i = 0; i < size; ++i) {
+        column[i] = -column[i];
+      }
+      break;
+    case OpCode::kPercent:
+      for (std::size_t i = 0; i < size; ++i) {
+        column[i] /= 100;
+      }
+      break;
+    default:
+      if (VectorMath::apply(code, column, size)) {
+        break;
+      }
+      for (std::size_t i = 0; i < size; ++i) {
+        column[i] = applyUnary(code, column[i]);
+      }
+      break;
+  }
+}
+
+/// @brief apply binary operation to columns
+/// @param code operation code
+/// @param lColumn left arguments, replaced by results
+/// @param rColumn right arguments
+/// @param size column size
+void Program::applyBinary(OpCode code, double *lColumn, const double *rColumn,
+                          std::size_t size) {
+  switch (code) {
+    case OpCode::kAdd:
+      for (std::size_t i = 0; i < size; ++i) {
+        lColumn[i] += rColumn[i];
+      }
+      break;
+    case OpCode::kSub:
+      for (std::size_t i = 0; i < size; ++i) {
+        lColumn[i] -= rColumn[i];
+      }
+      break;
+    case OpCode::kMul:
+      for (std::size_t i = 0; i < size; ++i) {
+        lColumn[i] *= rColumn[i];
+      }
+      break;
+    case OpCode::kDiv:
+      for (std::size_t i = 0; i < size; ++i) {
+        lColumn[i] /= rColumn[i];
+      }
+      break;
+    default:
+      for (std::size_t i = 0; i < size; ++i) {
+        lColumn[i] = applyBinary(code, lColumn[i], rColumn[i]);
+      }
+      break;
+  }
+}
+
+/// @brief fused multiply-add of columns, rounded once
+/// @param column first factors, replaced by results
+/// @param mColumn second factors
+/// @param aColumn addends
+/// @param size column size
+void Program::applyMulAdd(double *column, const double *mColumn,
+                          const double *aColumn, std::size_t size) {
+  if (VectorMath::applyMulAdd(column, mColumn, aColumn, size)) {
+    return;
+  }
+  for (std::size_t i = 0; i < size; ++i) {
+    column[i] = std::fma(column[i], mColumn[i], aColumn[i]);
+  }
+}
+
+/// @brief sin and cos of a column
+/// @param code kSinCos (sin to column, cos to stored), kCosSin or their
+/// fast versions
+/// @param column arguments, replaced by the first result
+/// @param stored second result
+/// @param size column size
+void Program::applySinCos(OpCode code, double *column, double *stored,
+                          std::size_t size) {
+  auto [first, second] = getSinCosParts(code);
+  bool sinFirst = first == OpCode::kSin || first == OpCode::kFastSin;
+  OpCode sinCode = sinFirst ? first : second;
+  OpCode cosCode = sinFirst ? second : first;
+  double *sinColumn = sinFirst ? column : stored;
+  double *cosColumn = sinFirst ? stored : column;
+  if (VectorMath::applySinCos(column, sinColumn, cosColumn, size,
+                              sinCode == OpCode::kFastSin)) {
+    return;
+  }
+  for (std::size_t i = 0; i < size; ++i) {
+    double arg = column[i];
+    sinColumn[i] = applyUnary(sinCode, arg);
+    cosColumn[i] = applyUnary(cosCode, arg);
+  }
+}
+
+/// @brief get operation of a superinstruction taking x as right operand
+/// @param code kAddX, kSubX, kMulX or kDivX
+/// @return kAdd, kSub, kMul or kDiv
+OpCode Program::getBaseOperation(OpCode code) {
+  switch (code) {
+    case OpCode::kAddX:
+      return OpCode::kAdd;
+    case OpCode::kSubX:
+      return OpCode::kSub;
+    case OpCode::kMulX:
+      return OpCode::kMul;
+    case OpCode::kDivX:
+      return OpCode::kDiv;
+    default:
+      return code;
+  }
+}
+
+/// @brief get operations of a sincos instruction
+/// @param code kSinCos, kCosSin, kFastSinCos or kFastCosSin
+/// @return operation of the result left on the stack and of the stored one,
+/// kNop for other codes
+std::pair<OpCode, OpCode> Program::getSinCosParts(OpCode code) {
+  switch (code) {
+    case OpCode::kSinCos:
+      return {OpCode::kSin, OpCode::kCos};
+    case OpCode::kCosSin:
+      return {OpCode::kCos, OpCode::kSin};
+    case OpCode::kFastSinCos:
+      return {OpCode::kFastSin, OpCode::kFastCos};
+    case OpCode::kFastCosSin:
+      return {OpCode::kFastCos, OpCode::kFastSin};
+    default:
+      return {OpCode::kNop, OpCode::kNop};
+  }
+}
+
+/// @brief get max evaluation stack depth
+/// @return size_t
+std::size_t Program::getStackDepth() const { return stackDepth_; }
+/// @brief get number of temporaries for shared subexpressions
+/// @return size_t
+std::size_t Program::getTemporaryCount() const { return temporaries_; }
+/// @brief get scratch size for evaluate(x, stack): stack and temporaries
+/// @return size_t
+std::size_t Program::getScratchSize() const {
+  return stackDepth_ + temporaries_;
+}
+/// @brief get number of instructions
+/// @return size_t
+std::size_t Program::getSize() const { return code_.size(); }
+/// @brief check if program is empty
+/// @return bool
+bool Program::isEmpty() const { return code_.empty(); }
+/// @brief get instructions
+/// @return span of instructions
+std::span<const Instruction> Program::getCode() const { return code_; }
+/// @brief get constant from the pool
+/// @param index operand of kPushConst
+/// @return double
+double Program::getConstant(std::uint32_t index) const {
+  return constants_[index];
+}
+
+}  // namespace s21
@@ -0,0 +1,152 @@
+#ifndef CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_PROGRAM_H_
+#define CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_PROGRAM_H_
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "budget.h"
+
+namespace s21 {
+//! Bytecode operation codes
+enum class OpCode : std::uint8_t {
+  kNop,        //!< never emitted (brackets)
+  kPushConst,  //!< push constant from the pool, operand = pool index
+  kPushX,      //!< push x value
+  kNegate,
+  kAdd,
+  kSub,
+  kMul,
+  kDiv,
+  kPow,
+  kMod,
+  kCos,
+  kSin,
+  kTan,
+  kAcos,
+  kAsin,
+  kAtan,
+  kLn,
+  kLog,
+  kSqrt,
+  kFactorial,
+  kPercent,
+  kStore,   //!< copy top of the stack to temporary, operand = temporary index
+  kLoad,    //!< push temporary, operand = temporary index
+  // superinstructions emitted by Optimizer::fuseInstructions
+  kAddX,    //!< top + x
+  kSubX,    //!< top - x
+  kMulX,    //!< top * x
+  kDivX,    //!< top / x
+  kMulAdd,  //!< a * b + c rounded once (fma)
+  kMulXAdd, //!< a * x + b rounded once, Horner step
+  kSinCos,  //!< sin of top, cos stored to temporary = operand
+  kCosSin,  //!< cos of top, sin stored to temporary = operand
+  // approximations emitted by Optimizer::relaxPrecision, see FastMath
+  kFastSin,
+  kFastCos,
+  kFastSinCos,  //!< kSinCos with kFastSin and kFastCos
+  kFastCosSin   //!< kCosSin with kFastCos and kFastSin
+};
+
+//! Scalar type of point-at-a-time evaluation
+enum class Precision { kFloat, kDouble, kLongDouble };
+
+//! Single bytecode instruction
+struct Instruction {
+  OpCode code;
+  std::uint32_t operand;
+};
+
+//! Compiled postfix expression
+/*!
+  Immutable flat bytecode program: instructions, constant pool and the
+  evaluation stack depth computed at compile time. Evaluation walks the
+  program over a caller-provided scratch buffer (the stack followed by the
+  temporaries shared subexpressions are stored to) without any allocation.
+  Point evaluation is templated on the scalar type (float, double or long
+  double), math routines run in that type except the fast math
+  approximations, which always run in double. Long double evaluation rounds
+  every result to double, the type of the constants and of the values
+  Optimizer::foldConstants() folds for it.
+
+  Batch evaluation runs the program column-at-a-time: each instruction is
+  applied to a whole block of x values before the next one is dispatched,
+  always in double. The overloads taking a BudgetMeter ask it before each
+  block and return the size of the evaluated prefix of ys.
+*/
+class Program {
+ public:
+  //! Builds a program from postfix tokens, tracks the stack depth
+  class Builder {
+   public:
+    void pushConstant(double value);
+    void pushOperation(OpCode code, std::uint32_t operand = 0);
+    Program build();
+
+   private:
+    std::vector<Instruction> code_;
+    std::vector<double> constants_;
+    std::size_t depth_{0};
+    std::size_t maxDepth_{0};
+    std::size_t temporaries_{0};
+  };
+
+  //! Number of x values processed per column
+  static constexpr std::size_t kBlockSize = 256;
+
+  Program() = default;
+  ~Program() = default;
+
+  template <class T>
+  T evaluate(T x, T *stack) const;
+  void evaluate(std::span<const double> xs, std::span<double> ys) const;
+  void evaluate(std::span<const double> xs, std::span<double> ys,
+                double *columns) const;
+  std::size_t evaluate(std::span<const double> xs, std::span<double> ys,
+                       BudgetMeter &meter) const;
+  std::size_t evaluate(std::span<const double> xs, std::span<double> ys,
+                       double *columns, BudgetMeter &meter) const;
+
+  // GETTERS
+  std::size_t getStackDepth() const;
+  std::size_t getTemporaryCount() const;
+  std::size_t getScratchSize() const;
+  std::size_t getSize() const;
+  bool isEmpty() const;
+  std::span<const Instruction> getCode() const;
+  double getConstant(std::uint32_t index) const;
+
+  static int getArity(OpCode code);
+  static OpCode getBaseOperation(OpCode code);
+  static std::pair<OpCode, OpCode> getSinCosParts(OpCode code);
+  template <class T>
+  static T applyUnary(OpCode code, T arg);
+  template <class T>
+  static T applyBinary(OpCode code, T lArg, T rArg);
+  static void applyUnary(OpCode code, double *column, std::size_t size);
+  static void applyBinary(OpCode code, double *lColumn, const double *rColumn,
+                          std::size_t size);
+  static void applyMulAdd(double *column, const double *mColumn,
+                          const double *aColumn, std::size_t size);
+  static void applySinCos(OpCode code, double *column, double *stored,
+                          std::size_t size);
+
+ private:
+  std::vector<Instruction> code_;
+  std::vector<double> constants_;
+  std::size_t stackDepth_{0};
+  std::size_t temporaries_{0};
+
+  void evaluateBlock(const double *xs, double *ys, std::size_t size,
+                     double *columns) const;
+};
+
+}  // namespace s21
+
+#endif  // CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_PROGRAM_H_
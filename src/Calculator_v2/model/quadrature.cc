@@ -0,0 +1,123 @@
+#include "quadrature.h"
+
+#include <algorithm>
+#include <limits>
+
+namespace s21 {
+
+namespace {
+
+// Kronrod nodes on [-1, 1], the odd ones are the Gauss nodes, the last is 0
+constexpr double kKronrodNodes[8] = {
+    0.991455371120812639206854697526329, 0.949107912342758524526189684047851,
+    0.864864423359769072789712788640926, 0.741531185599394439863864773280788,
+    0.586087235467691130294144845693013, 0.405845151377397166906606412076961,
+    0.207784955007898467600689403773245, 0.0};
+constexpr double kKronrodWeights[8] = {
+    0.022935322010529224963732008058970, 0.063092092629978553290700663189204,
+    0.104790010322250183839876322541518, 0.140653259715525918745189590510238,
+    0.169004726639267902826583426598550, 0.190350578064785409913256402421014,
+    0.204432940075298892414161999234649, 0.209482141084727828012999174891714};
+constexpr double kGaussWeights[4] = {
+    0.129484966168869693270611432679082, 0.279705391489276667901467771423780,
+    0.381830050505118944950369775488975, 0.417959183673469387755102040816327};
+
+// rounding error of the rule in units of the integral of |f|
+constexpr double kRoundoff = 50 * std::numeric_limits<double>::epsilon();
+
+}  // namespace
+
+/******************************************************************************
+ *                                                                            *
+ *                            Quadrature class                                *
+ *                                                                            *
+ ******************************************************************************/
+
+/// @brief nodes of rule() on a segment
+/// @param lo left end
+/// @param hi right end
+/// @param xs kNodes x values: the center, then pairs symmetric about it
+void Quadrature::nodes(double lo, double hi, std::span<double> xs) {
+  double center = lo + (hi - lo) / 2;
+  double half = (hi - lo) / 2;
+  xs[0] = center;
+  for (std::size_t j = 0; j < 7; ++j) {
+    xs[1 + 2 * j] = center - half * kKronrodNodes[j];
+    xs[2 + 2 * j] = center + half * kKronrodNodes[j];
+  }
+}
+
+/// @brief integrate one segment from f at its nodes()
+/// @param lo left end
+/// @param hi right end
+/// @param ys kNodes f(x) values at nodes(lo, hi)
+/// @return Segment, value and error are NaN if some f(x) is not finite
+Quadrature::Segment Quadrature::rule(double lo, double hi,
+                                     std::span<const double> ys) {
+  double half = (hi - lo) / 2;
+  double kronrod = kKronrodWeights[7] * ys[0];
+  double gauss = kGaussWeights[3] * ys[0];
+  double absolute = kKronrodWeights[7] * std::abs(ys[0]);
+  for (std::size_t j = 0; j < 7; ++j) {
+    double sum = ys[1 + 2 * j] + ys[2 + 2 * j];
+    kronrod += kKronrodWeights[j] * sum;
+    absolute += kKronrodWeights[j] *
+                (std::abs(ys[1 + 2 * j]) + std::abs(ys[2 + 2 * j]));
+    if (j % 2 == 1) {
+      gauss += kGaussWeights[j / 2] * sum;
+    }
+  }
+  double value = kronrod * half;
+  double absValue = absolute * std::abs(half);
+  double error = std::abs((kronrod - gauss) * half);
+  if (!std::isfinite(value)) {
+    value = error = NAN;
+  }
+  return {lo, hi, value, std::max(error, kRoundoff * absValue), absValue};
+}
+
+/// @brief pick the segments to split: every segment with a NaN error, then
+/// the fewest largest errors that sum to excess. Segments at the rounding
+/// error or too narrow to halve are kept
+/// @param segments segments
+/// @param excess error of the segments with finite errors above the
+/// tolerance
+/// @param maxSplits max number of segments
+/// @return std::vector<size_t> indices, NaN errors first, then largest error
+/// first
+std::vector<std::size_t> Quadrature::select(
+    const std::vector<Segment> &segments, double excess,
+    std::size_t maxSplits) {
+  auto errorOf = [&](std::size_t i) {
+    double error = segments[i].error;
+    return std::isnan(error) ? std::numeric_limits<double>::infinity() : error;
+  };
+  std::vector<std::size_t> candidates;
+  for (std::size_t i = 0; i < segments.size(); ++i) {
+    const Segment &segment = segments[i];
+    double middle = segment.lo + (segment.hi - segment.lo) / 2;
+    bool halves = middle > segment.lo && middle < segment.hi;
+    if (halves && !(segment.error <= kRoundoff * segment.absValue)) {
+      candidates.push_back(i);
+    }
+  }
+  std::stable_sort(
+      candidates.begin(), candidates.end(),
+      [&](std::size_t a, std::size_t b) { return errorOf(a) > errorOf(b); });
+  std::size_t count = 0;
+  double picked = 0;
+  while (count < candidates.size() && count < maxSplits) {
+    double error = errorOf(candidates[count]);
+    if (!std::isinf(error)) {
+      if (picked >= excess) {
+        break;
+      }
+      picked += error;
+    }
+    ++count;
+  }
+  candidates.resize(count);
+  return candidates;
+}
+
+}  // namespace s21
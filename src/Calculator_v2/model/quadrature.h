@@ -0,0 +1,50 @@
+#ifndef CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_QUADRATURE_H_
+#define CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_QUADRATURE_H_
+
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace s21 {
+
+//! Definite integral and its error estimate
+struct Integral {
+  double value{NAN};
+  double error{NAN};  //!< estimated absolute error
+  std::size_t evaluations{0};
+  bool converged{false};  //!< error within tolerance before the budget ran out
+};
+
+//! Gauss-Kronrod quadrature
+/*!
+  rule() integrates one segment with the 15-point Kronrod rule, the error
+  estimate is its difference from the embedded 7-point Gauss rule (exact for
+  polynomials up to degree 22 and 13), floored at the rounding error of the
+  sum. Adaptive integration splits the segments select() picks in rounds:
+  the new halves of a round are independent, so their nodes can be evaluated
+  in parallel. Nodes are inside the segment, so integrable singularities at
+  the ends are never evaluated.
+*/
+class Quadrature {
+ public:
+  //! Integral of one segment
+  struct Segment {
+    double lo;
+    double hi;
+    double value;
+    double error;
+    double absValue;  //!< integral of |f|, scale of the rounding error
+  };
+  //! Nodes of rule()
+  static constexpr std::size_t kNodes = 15;
+
+  static void nodes(double lo, double hi, std::span<double> xs);
+  static Segment rule(double lo, double hi, std::span<const double> ys);
+  static std::vector<std::size_t> select(const std::vector<Segment> &segments,
+                                         double excess, std::size_t maxSplits);
+};
+
+}  // namespace s21
+
+#endif  // CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_QUADRATURE_H_
@@ -0,0 +1,165 @@
+#include "rootFinder.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace s21 {
+
+namespace {
+
+constexpr double kEpsilon = std::numeric_limits<double>::epsilon();
+
+/// @brief check if a and b are non-zero numbers of opposite signs
+bool oppositeSigns(double a, double b) {
+  return (a < 0 && b > 0) || (a > 0 && b < 0);
+}
+
+/// @brief kind of extremum where f' changes sign from slope
+CriticalPoint::Kind extremumKind(double slope) {
+  return slope > 0 ? CriticalPoint::Kind::kMaximum
+                   : CriticalPoint::Kind::kMinimum;
+}
+
+/// @brief find a zero of g between lo and hi, g(lo) and g(hi) of opposite
+/// signs: Newton steps where g' is known, Illinois regula falsi steps where
+/// it is NaN, bisection where they fail
+/// @param function returns Dual g(x) and g'(x)
+/// @param lo left end
+/// @param hi right end
+/// @param gLo g(lo)
+/// @param gHi g(hi)
+/// @return double zero, NaN if g is NaN inside the bracket
+template <class Function>
+double solve(const Function &function, double lo, double hi, double gLo,
+             double gHi) {
+  // stop at the rounding of x, or of the bracket width near x = 0
+  const double scale = hi - lo;
+  // regula falsi weights: the value at an end kept twice in a row is halved
+  double wLo = gLo, wHi = gHi;
+  int movedEnd = 0;  // 1 if lo moved last, -1 if hi
+  double width = hi - lo;
+  double x = lo + (hi - lo) / 2;
+  for (int iteration = 0; iteration < RootFinder::kMaxIterations;
+       ++iteration) {
+    Dual g = function(x);
+    if (g.value == 0) {
+      return x;
+    }
+    if (std::isnan(g.value)) {
+      return NAN;
+    }
+    if ((g.value < 0) == (gLo < 0)) {
+      lo = x;
+      gLo = wLo = g.value;
+      if (movedEnd > 0) {
+        wHi /= 2;
+      }
+      movedEnd = 1;
+    } else {
+      hi = x;
+      gHi = wHi = g.value;
+      if (movedEnd < 0) {
+        wLo /= 2;
+      }
+      movedEnd = -1;
+    }
+    double next = std::isfinite(g.derivative) && g.derivative != 0
+                      ? x - g.value / g.derivative
+                      : lo - wLo * (hi - lo) / (wHi - wLo);
+    double tolerance = kEpsilon * std::max(std::abs(x), scale);
+    if (std::abs(next - x) <= tolerance || hi - lo <= tolerance) {
+      return next > lo && next < hi ? next : x;
+    }
+    if (iteration % 2 == 1) {
+      if (hi - lo > width / 2) {
+        next = NAN;
+      }
+      width = hi - lo;
+    }
+    x = next > lo && next < hi ? next : lo + (hi - lo) / 2;
+  }
+  return x;
+}
+
+}  // namespace
+
+/******************************************************************************
+ *                                                                            *
+ *                            RootFinder class                                *
+ *                                                                            *
+ ******************************************************************************/
+
+/// @brief find sign changes of f and f' sampled on a grid
+/// @param xs ascending x values
+/// @param ys f(x) values, same size as xs
+/// @param dys f'(x) values, same size as xs
+/// @return std::vector<Bracket> in the order of xs
+std::vector<RootFinder::Bracket> RootFinder::bracket(
+    std::span<const double> xs, std::span<const double> ys,
+    std::span<const double> dys) {
+  std::vector<Bracket> brackets;
+  std::size_t size = xs.size();
+  for (std::size_t i = 0; i < size; ++i) {
+    bool inner = i > 0 && i + 1 < size;
+    // zeros at grid points, runs of zeros are not isolated roots
+    if (ys[i] == 0 && (i == 0 || ys[i - 1] != 0) &&
+        (i + 1 == size || ys[i + 1] != 0)) {
+      brackets.push_back({CriticalPoint::Kind::kRoot, xs[i], xs[i], 0, 0});
+    }
+    if (dys[i] == 0 && inner && oppositeSigns(dys[i - 1], dys[i + 1])) {
+      brackets.push_back({extremumKind(dys[i - 1]), xs[i], xs[i], 0, 0});
+    }
+    if (i + 1 < size) {
+      if (oppositeSigns(ys[i], ys[i + 1])) {
+        brackets.push_back({CriticalPoint::Kind::kRoot, xs[i], xs[i + 1],
+                            ys[i], ys[i + 1]});
+      }
+      if (oppositeSigns(dys[i], dys[i + 1])) {
+        brackets.push_back(
+            {extremumKind(dys[i]), xs[i], xs[i + 1], dys[i], dys[i + 1]});
+      }
+    }
+  }
+  return brackets;
+}
+
+/// @brief narrow a bracket down to a root or an extremum
+/// @param program program
+/// @param bracket bracket of bracket()
+/// @param stack scratch buffer of at least program.getScratchSize() elements
+/// @param intervals scratch buffer of at least program.getScratchSize()
+/// elements
+/// @return CriticalPoint, none across a pole or a jump or where f is not
+/// finite
+std::optional<CriticalPoint> RootFinder::refine(const Program &program,
+                                                const Bracket &bracket,
+                                                Dual *stack,
+                                                Interval *intervals) {
+  double x = bracket.lo;
+  if (bracket.lo != bracket.hi) {
+    if (IntervalMath::evaluate(program, {bracket.lo, bracket.hi}, intervals)
+            .discontinuous) {
+      return std::nullopt;
+    }
+    if (bracket.kind == CriticalPoint::Kind::kRoot) {
+      x = solve(
+          [&](double t) { return DualMath::evaluate(program, t, stack); },
+          bracket.lo, bracket.hi, bracket.gLo, bracket.gHi);
+    } else {
+      // no second derivative: NaN slope selects regula falsi
+      x = solve(
+          [&](double t) {
+            return Dual{DualMath::evaluate(program, t, stack).derivative, NAN};
+          },
+          bracket.lo, bracket.hi, bracket.gLo, bracket.gHi);
+    }
+  }
+  double y = DualMath::evaluate(program, x, stack).value;
+  if (!std::isfinite(y)) {
+    return std::nullopt;
+  }
+  return CriticalPoint{bracket.kind, x, y};
+}
+
+}  // namespace s21
@@ -0,0 +1,59 @@
+#ifndef CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_ROOTFINDER_H_
+#define CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_ROOTFINDER_H_
+
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "dualMath.h"
+#include "intervalMath.h"
+
+namespace s21 {
+
+//! Root or local extremum of a function
+struct CriticalPoint {
+  enum class Kind { kRoot, kMinimum, kMaximum };
+
+  Kind kind;
+  double x;
+  double y;
+};
+
+//! Roots and extrema between samples of a graph
+/*!
+  bracket() scans f and f' sampled on a grid for sign changes: a sign change
+  of f brackets a root, one of f' brackets a minimum or a maximum. Exact zeros
+  at grid points give zero width brackets. refine() narrows one bracket down
+  to the rounding of x, or of the bracket width near x = 0: roots by Newton
+  steps with f' from dual numbers, extrema by Illinois regula falsi on f'.
+  Steps that leave the bracket or do not halve it every two iterations are
+  replaced by bisection, so refinement always converges. Brackets across
+  poles and jumps, flagged discontinuous by IntervalMath, are rejected: there
+  f changes sign without a root. Brackets are independent, so they can be
+  refined in parallel.
+*/
+class RootFinder {
+ public:
+  //! Sign change of f (kRoot) or of f' between lo and hi
+  struct Bracket {
+    CriticalPoint::Kind kind;
+    double lo;
+    double hi;
+    double gLo;  //!< f(lo) for roots, f'(lo) for extrema
+    double gHi;  //!< f(hi) for roots, f'(hi) for extrema
+  };
+  //! Max iterations of refine(), bisection alone needs about 55 to reach
+  //! the tolerance
+  static constexpr int kMaxIterations = 100;
+
+  static std::vector<Bracket> bracket(std::span<const double> xs,
+                                      std::span<const double> ys,
+                                      std::span<const double> dys);
+  static std::optional<CriticalPoint> refine(const Program &program,
+                                             const Bracket &bracket,
+                                             Dual *stack, Interval *intervals);
+};
+
+}  // namespace s21
+
+#endif  // CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_ROOTFINDER_H_
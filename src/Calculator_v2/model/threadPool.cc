@@ -0,0 +1,90 @@
+#include "threadPool.h"
+
+namespace s21 {
+
+/// @brief ThreadPool constructor, starts threads - 1 workers, the thread
+/// calling parallelFor() is the last one
+/// @param threads total number of threads, at least 1
+ThreadPool::ThreadPool(std::size_t threads) {
+  for (std::size_t i = 1; i < threads; ++i) {
+    workers_.emplace_back(&ThreadPool::workerLoop, this);
+  }
+}
+
+/// @brief ThreadPool destructor, stops and joins workers
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stop_ = true;
+  }
+  wakeUp_.notify_all();
+  for (std::thread &worker : workers_) {
+    worker.join();
+  }
+}
+
+/// @brief run task(i) for each i in [0, count) and wait for completion,
+/// the first exception thrown by a task is rethrown
+/// @param count number of task indices
+/// @param task function of the index
+void ThreadPool::parallelFor(std::size_t count, const Task &task) {
+  std::lock_guard<std::mutex> runLock(runMutex_);
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    task_ = &task;
+    count_ = count;
+    next_ = 0;
+    error_ = nullptr;
+    busyWorkers_ = workers_.size();
+    ++generation_;
+  }
+  wakeUp_.notify_all();
+  runTasks();
+  std::unique_lock<std::mutex> lock(mutex_);
+  done_.wait(lock, [this] { return busyWorkers_ == 0; });
+  task_ = nullptr;
+  if (error_) {
+    std::rethrow_exception(error_);
+  }
+}
+
+/// @brief worker thread main loop
+void ThreadPool::workerLoop() {
+  std::size_t seenGeneration = 0;
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      wakeUp_.wait(lock,
+                   [&] { return stop_ || generation_ != seenGeneration; });
+      if (stop_) {
+        return;
+      }
+      seenGeneration = generation_;
+    }
+    runTasks();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (--busyWorkers_ == 0) {
+      done_.notify_one();
+    }
+  }
+}
+
+/// @brief take task indices until none left
+void ThreadPool::runTasks() {
+  for (std::size_t i = next_++; i < count_; i = next_++) {
+    try {
+      (*task_)(i);
+    } catch (...) {
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!error_) {
+        error_ = std::current_exception();
+      }
+    }
+  }
+}
+
+/// @brief get total number of threads including the calling one
+/// @return size_t
+std::size_t ThreadPool::getThreadCount() const { return workers_.size() + 1; }
+
+}  // namespace s21
@@ -0,0 +1,56 @@
+#ifndef CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_THREADPOOL_H_
+#define CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_THREADPOOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace s21 {
+
+//! Fixed-size reusable pool of worker threads
+/*!
+  parallelFor() hands out task indices to the workers and the calling thread
+  and blocks until every index is processed. Which thread runs an index is
+  not deterministic, so tasks must write to disjoint outputs.
+*/
+class ThreadPool {
+ public:
+  using Task = std::function<void(std::size_t)>;
+
+  explicit ThreadPool(std::size_t threads);
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+  ~ThreadPool();
+
+  void parallelFor(std::size_t count, const Task &task);
+
+  // GETTERS
+  std::size_t getThreadCount() const;
+
+ private:
+  std::vector<std::thread> workers_;
+  std::mutex runMutex_;  //!< one parallelFor at a time
+  std::mutex mutex_;
+  std::condition_variable wakeUp_;
+  std::condition_variable done_;
+  bool stop_{false};
+  std::size_t generation_{0};
+  std::size_t busyWorkers_{0};
+
+  const Task *task_{nullptr};
+  std::size_t count_{0};
+  std::atomic<std::size_t> next_{0};
+  std::exception_ptr error_;
+
+  void workerLoop();
+  void runTasks();
+};
+
+}  // namespace s21
+
+#endif  // CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_THREADPOOL_H_
@@ -0,0 +1,180 @@
+#include "token.h"
+
+#include <array>
+#include <cstdint>
+
+namespace s21 {
+
+/******************************************************************************
+ *                                                                            *
+ *                               Token class                                  *
+ *                                                                            *
+ ******************************************************************************/
+
+/// @brief public function to make a token number
+/// @param name token name (number)
+/// @param value number
+void Token::makeNumber(std::string_view name, double value) {
+  *this = Token(name, kDefault, kNone, kNumber, OpCode::kPushConst, value);
+}
+
+/// @brief public function to change this token to ~ unary minus
+void Token::makeUnaryNegative() {
+  std::size_t position = position_;
+  *this = TokenTable::getUnaryNegative();
+  position_ = position;
+}
+
+/// @brief set offset of the token in the parsed expression
+/// @param position size_t
+void Token::setPosition(std::size_t position) { position_ = position; }
+
+/// @brief get name from token
+/// @return string_view
+std::string_view Token::getName() const { return name_; }
+/// @brief get type from token
+/// @return Type
+Type Token::getType() const { return type_; }
+/// @brief get precedence from token
+/// @return Precedence
+Precedence Token::getPrecedence() const { return precedence_; }
+/// @brief get token associativity
+/// @return Associativity
+Associativity Token::getAssociativity() const { return associativity_; }
+/// @brief get bytecode operation from token
+/// @return OpCode
+OpCode Token::getOpCode() const { return code_; }
+/// @brief get number value from token
+/// @return double
+double Token::getValue() const { return value_; }
+/// @brief get offset of the token in the parsed expression
+/// @return size_t
+std::size_t Token::getPosition() const { return position_; }
+
+/******************************************************************************
+ *                                                                            *
+ *                             TokenTable class                               *
+ *                                                                            *
+ ******************************************************************************/
+
+namespace {
+
+struct Entry {
+  std::string_view key;
+  Token token;
+};
+
+constexpr std::array<Entry, 21> kEntries = {{
+    {"x", {"x", kDefault, kNone, kNumber, OpCode::kPushX}},
+    {" ", {"space", kDefault, kNone, kNumber, OpCode::kPushX}},
+    {"(", {"(", kDefault, kNone, kOpenBracket, OpCode::kNop}},
+    {")", {")", kDefault, kNone, kCloseBracket, OpCode::kNop}},
+    {"+", {"+", kLow, kLeft, kBinaryOperator, OpCode::kAdd}},
+    {"-", {"-", kLow, kLeft, kBinaryOperator, OpCode::kSub}},
+    {"*", {"*", kMedium, kLeft, kBinaryOperator, OpCode::kMul}},
+    {"/", {"/", kMedium, kLeft, kBinaryOperator, OpCode::kDiv}},
+    {"^", {"^", kHigh, kRight, kBinaryOperator, OpCode::kPow}},
+    {"mod", {"mod", kMedium, kLeft, kBinaryOperator, OpCode::kMod}},
+    {"cos", {"cos", kFunction, kRight, kUnaryFunction, OpCode::kCos}},
+    {"sin", {"sin", kFunction, kRight, kUnaryFunction, OpCode::kSin}},
+    {"tan", {"tan", kFunction, kRight, kUnaryFunction, OpCode::kTan}},
+    {"acos", {"acos", kFunction, kRight, kUnaryFunction, OpCode::kAcos}},
+    {"asin", {"asin", kFunction, kRight, kUnaryFunction, OpCode::kAsin}},
+    {"atan", {"atan", kFunction, kRight, kUnaryFunction, OpCode::kAtan}},
+    {"ln", {"ln", kFunction, kRight, kUnaryFunction, OpCode::kLn}},
+    {"log", {"log", kFunction, kRight, kUnaryFunction, OpCode::kLog}},
+    {"sqrt", {"sqrt", kFunction, kRight, kUnaryFunction, OpCode::kSqrt}},
+    {"!", {"!", kUnaryOperator, kLeft, kUnaryPostfixOperator,
+           OpCode::kFactorial}},
+    {"%",
+     {"%", kUnaryOperator, kLeft, kUnaryPostfixOperator, OpCode::kPercent}},
+}};
+
+constexpr Token kUnaryNegative("~", kUnaryOperator, kRight,
+                               kUnaryPrefixOperator, OpCode::kNegate);
+
+constexpr std::size_t kNumSlots = 64;
+constexpr std::uint8_t kEmptySlot = 0xff;
+using Slots = std::array<std::uint8_t, kNumSlots>;
+
+constexpr char toLower(char symbol) {
+  return (symbol >= 'A' && symbol <= 'Z') ? symbol - 'A' + 'a' : symbol;
+}
+
+/// FNV-1a over lowercased key, folded to a slot index
+constexpr std::size_t hashKey(std::string_view key, std::uint32_t seed) {
+  std::uint32_t hash = 2166136261u ^ seed;
+  for (char symbol : key) {
+    hash ^= static_cast<unsigned char>(toLower(symbol));
+    hash *= 16777619u;
+  }
+  return (hash ^ (hash >> 15)) % kNumSlots;
+}
+
+constexpr bool tryBuildSlots(std::uint32_t seed, Slots &slots) {
+  for (std::uint8_t &slot : slots) {
+    slot = kEmptySlot;
+  }
+  for (std::size_t i = 0; i < kEntries.size(); ++i) {
+    std::size_t slot = hashKey(kEntries[i].key, seed);
+    if (slots[slot] != kEmptySlot) {
+      return false;
+    }
+    slots[slot] = static_cast<std::uint8_t>(i);
+  }
+  return true;
+}
+
+constexpr std::uint32_t findSeed() {
+  Slots slots{};
+  std::uint32_t seed = 0;
+  while (!tryBuildSlots(seed, slots)) {
+    ++seed;
+  }
+  return seed;
+}
+
+constexpr std::uint32_t kSeed = findSeed();
+
+constexpr Slots buildSlots() {
+  Slots slots{};
+  tryBuildSlots(kSeed, slots);
+  return slots;
+}
+
+constexpr Slots kSlots = buildSlots();
+
+constexpr bool equalsIgnoreCase(std::string_view lhs, std::string_view rhs) {
+  if (lhs.size() != rhs.size()) {
+    return false;
+  }
+  for (std::size_t i = 0; i < lhs.size(); ++i) {
+    if (toLower(lhs[i]) != toLower(rhs[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+/// @brief find operator or function token, case-insensitive
+/// @param key token text from the input
+/// @return pointer to the static token or nullptr
+const Token *TokenTable::find(std::string_view key) {
+  std::uint8_t index = kSlots[hashKey(key, kSeed)];
+  if (index == kEmptySlot || !equalsIgnoreCase(kEntries[index].key, key)) {
+    return nullptr;
+  }
+  return &kEntries[index].token;
+}
+
+/// @brief get ~ unary minus token
+/// @return const Token&
+const Token &TokenTable::getUnaryNegative() { return kUnaryNegative; }
+
+/// @brief get * token for implicit multiplication
+/// @return const Token&
+const Token &TokenTable::getMultiply() { return *find("*"); }
+
+}  // namespace s21
@@ -0,0 +1,83 @@
+#ifndef CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_TOKEN_H_
+#define CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_TOKEN_H_
+
+#include <cstddef>
+#include <string_view>
+
+#include "program.h"
+
+namespace s21 {
+//! Token types
+enum Type {
+  kNumber,
+  kBinaryOperator,
+  kUnaryPrefixOperator,
+  kUnaryPostfixOperator,
+  kUnaryFunction,
+  kOpenBracket,
+  kCloseBracket,
+  kNumTokenType
+};
+//! Token precedence
+enum Precedence { kDefault, kLow, kMedium, kHigh, kUnaryOperator, kFunction };
+//! Operator-tokens / function-tokens associativity
+enum Associativity { kNone, kLeft, kRight };
+
+//! Token class
+/*!
+  Literal type: operator tokens live in the static TokenTable, number tokens
+  keep a view of their text in the parsed expression.
+*/
+class Token {
+ public:
+  constexpr Token() = default;
+  constexpr Token(std::string_view name, Precedence precedence,
+                  Associativity associativity, Type type, OpCode code,
+                  double value = 0.0)
+      : name_(name),
+        type_(type),
+        precedence_(precedence),
+        associativity_(associativity),
+        code_(code),
+        value_(value) {}
+  ~Token() = default;
+
+  void makeNumber(std::string_view name, double value);
+  void makeUnaryNegative();
+  void setPosition(std::size_t position);
+
+  // GETTERS
+  std::string_view getName() const;
+  Type getType() const;
+  Precedence getPrecedence() const;
+  Associativity getAssociativity() const;
+  OpCode getOpCode() const;
+  double getValue() const;
+  std::size_t getPosition() const;
+
+ private:
+  std::string_view name_;
+  Type type_{kNumber};
+  Precedence precedence_{kDefault};
+  Associativity associativity_{kNone};
+  OpCode code_{OpCode::kNop};
+  double value_{0.0};
+  std::size_t position_{0};  //!< offset in the parsed expression
+};
+
+//! Static operator and function table
+/*!
+  Built at compile time and shared by all CalcModel instances and threads.
+  Lookup is a case-insensitive perfect hash: the hash seed is searched at
+  compile time so that every key lands in its own slot.
+*/
+class TokenTable {
+ public:
+  static const Token *find(std::string_view key);
+  static const Token &getUnaryNegative();
+  static const Token &getMultiply();
+};
+
+}  // namespace s21
+
+#endif  // CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_TOKEN_H_
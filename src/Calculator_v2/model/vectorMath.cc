@@ -0,0 +1,213 @@
+#include "vectorMath.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#include "fastMath.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <immintrin.h>
+#define S21_VECTOR_MATH_X86
+#endif
+
+namespace s21 {
+
+#ifdef S21_VECTOR_MATH_X86
+namespace {
+
+constexpr double kRoundMagic = 0x1.8p52;
+constexpr double kTwoOverPi = 6.36619772367581382433e-01;
+// pi / 2 split into three parts (Cephes DP1..DP3 times two), the first two
+// have 26 significant bits so q * part is exact for |q| < 2^27
+constexpr double kPio2Part1 = 1.57079625129699707031e+00;
+constexpr double kPio2Part2 = 7.54978941586159635336e-08;
+constexpr double kPio2Part3 = 5.39030285815811905290e-15;
+constexpr double kMaxTrigArg = 0x1p20;
+
+constexpr double kSinCoef[] = {
+    1.58962301576546568060e-10, -2.50507477628578072866e-08,
+    2.75573136213857245213e-06, -1.98412698295895385996e-04,
+    8.33333333332211858878e-03, -1.66666666666666307295e-01};
+constexpr double kCosCoef[] = {
+    -1.13585365213876817300e-11, 2.08757008419747316778e-09,
+    -2.75573141792967388112e-07, 2.48015872888517045348e-05,
+    -1.38888888888730564116e-03, 4.16666666666665929218e-02};
+
+constexpr double kSqrt2 = 1.41421356237309504880e+00;
+constexpr double kLn2Hi = 6.93147180369123816490e-01;
+constexpr double kLn2Lo = 1.90821492927058770002e-10;
+constexpr double kLog10Of2Hi = 3.01029995663611771306e-01;
+constexpr double kLog10Of2Lo = 3.69423907715893078616e-13;
+constexpr double kInvLn10 = 4.34294481903251816668e-01;
+constexpr double kLg[] = {6.666666666666735130e-01, 3.999999999940941908e-01,
+                          2.857142874366239149e-01, 2.222219843214978396e-01,
+                          1.818357216161805012e-01, 1.531383769920937332e-01,
+                          1.479819860511658591e-01};
+constexpr double kMinNormal = 0x1p-1022;
+constexpr double kMaxFinite = 0x1.fffffffffffffp1023;
+
+constexpr double kTan3Pi8 = 2.41421356237309504880e+00;
+constexpr double kPio2 = 1.57079632679489661923e+00;
+constexpr double kPio4 = 7.85398163397448309616e-01;
+constexpr double kMoreBits = 6.123233995736765886130e-17;
+constexpr double kAtanP[] = {
+    -8.750608600031904122785e-01, -1.615753718733365076637e+01,
+    -7.500855792314704667340e+01, -1.228866684490136173410e+02,
+    -6.485021904942025371773e+01};
+constexpr double kAtanQ[] = {
+    1.0, 2.485846490142306297962e+01, 1.650270098316988542046e+02,
+    4.328810604912902668951e+02, 4.853903996359136964868e+02,
+    1.945506571482613964425e+02};
+
+}  // namespace
+
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+namespace avx2 {
+constexpr int kLanes = 4;
+#include "vectorMathKernels.inc"
+}  // namespace avx2
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+namespace avx512 {
+constexpr int kLanes = 8;
+#include "vectorMathKernels.inc"
+}  // namespace avx512
+#pragma GCC pop_options
+#endif  // S21_VECTOR_MATH_X86
+
+namespace {
+
+VectorMath::Isa detectIsa() {
+#ifdef S21_VECTOR_MATH_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    return VectorMath::Isa::kAvx512;
+  }
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    return VectorMath::Isa::kAvx2;
+  }
+#endif
+  return VectorMath::Isa::kScalar;
+}
+
+std::atomic<VectorMath::Isa> currentIsa{VectorMath::getSupportedIsa()};
+
+}  // namespace
+
+/// @brief get instruction set used by apply()
+/// @return Isa
+VectorMath::Isa VectorMath::getIsa() { return currentIsa.load(); }
+
+/// @brief get best instruction set supported by the CPU, detected once
+/// @return Isa
+VectorMath::Isa VectorMath::getSupportedIsa() {
+  static const Isa supported = detectIsa();
+  return supported;
+}
+
+/// @brief select instruction set, e.g. to compare kernels, clamped to the
+/// supported one
+/// @param isa Isa
+void VectorMath::setIsa(Isa isa) {
+  currentIsa.store(std::min(isa, getSupportedIsa()));
+}
+
+/// @brief check if operation has a vector kernel
+/// @param code operation code
+/// @return bool
+bool VectorMath::hasKernel(OpCode code) {
+  switch (code) {
+    case OpCode::kSin:
+    case OpCode::kCos:
+    case OpCode::kTan:
+    case OpCode::kAtan:
+    case OpCode::kAsin:
+    case OpCode::kAcos:
+    case OpCode::kLn:
+    case OpCode::kLog:
+    case OpCode::kSqrt:
+    case OpCode::kFastSin:
+    case OpCode::kFastCos:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/// @brief apply unary operation to a column with the current instruction set
+/// @param code operation code
+/// @param column values, replaced by results
+/// @param size column size
+/// @return false if there is no kernel, column is left unchanged
+bool VectorMath::apply(OpCode code, double *column, std::size_t size) {
+  switch (getIsa()) {
+#ifdef S21_VECTOR_MATH_X86
+    case Isa::kAvx512:
+      return avx512::apply(code, column, size);
+    case Isa::kAvx2:
+      return avx2::apply(code, column, size);
+#endif
+    default:
+      return false;
+  }
+}
+
+/// @brief sin and cos of a column with the current instruction set
+/// @param column arguments, may be one of the result columns
+/// @param sinColumn sin results
+/// @param cosColumn cos results
+/// @param size column size
+/// @param fast kFastSin and kFastCos instead of kSin and kCos
+/// @return false if there is no kernel, columns are left unchanged
+bool VectorMath::applySinCos(const double *column, double *sinColumn,
+                             double *cosColumn, std::size_t size, bool fast) {
+  switch (getIsa()) {
+#ifdef S21_VECTOR_MATH_X86
+    case Isa::kAvx512:
+      if (fast) {
+        avx512::sinCos<true>(column, sinColumn, cosColumn, size);
+      } else {
+        avx512::sinCos<false>(column, sinColumn, cosColumn, size);
+      }
+      return true;
+    case Isa::kAvx2:
+      if (fast) {
+        avx2::sinCos<true>(column, sinColumn, cosColumn, size);
+      } else {
+        avx2::sinCos<false>(column, sinColumn, cosColumn, size);
+      }
+      return true;
+#endif
+    default:
+      return false;
+  }
+}
+
+/// @brief column = column * mColumn + aColumn rounded once
+/// @param column first factors, replaced by results
+/// @param mColumn second factors
+/// @param aColumn addends
+/// @param size column size
+/// @return false if there is no kernel, column is left unchanged
+bool VectorMath::applyMulAdd(double *column, const double *mColumn,
+                             const double *aColumn, std::size_t size) {
+  switch (getIsa()) {
+#ifdef S21_VECTOR_MATH_X86
+    case Isa::kAvx512:
+      avx512::mulAdd(column, mColumn, aColumn, size);
+      return true;
+    case Isa::kAvx2:
+      avx2::mulAdd(column, mColumn, aColumn, size);
+      return true;
+#endif
+    default:
+      return false;
+  }
+}
+
+}  // namespace s21
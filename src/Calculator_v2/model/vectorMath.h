@@ -0,0 +1,56 @@
+#ifndef CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_VECTORMATH_H_
+#define CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_VECTORMATH_H_
+
+#include <cstddef>
+
+#include "program.h"
+
+namespace s21 {
+
+//! SIMD math kernels for batch evaluation with runtime CPU dispatch
+/*!
+  AVX2 (4 lanes) and AVX-512 (8 lanes) versions share one implementation
+  written with GCC vector extensions. The scalar fallback is the double libm
+  used by the point-at-a-time evaluator. Lanes outside a kernel's domain
+  (non-finite values, |x| > 2^20 for trigonometry, non-normal values for
+  logarithms) are computed with the scalar fallback.
+
+  Maximum error against the exact value, measured on 10^6 random arguments
+  per function (bounds are checked by the VectorMath tests): sqrt 0.5 ulp
+  (correctly rounded); ln, atan 1 ulp; sin, cos 1.6 ulp; log, acos 2 ulp;
+  asin 2.5 ulp; tan 3.5 ulp. The tail of a column is padded to a full vector,
+  so every element goes through the same code whatever its position.
+
+  The kFastSin and kFastCos kernels of the fast math mode compute the
+  FastMath approximations (see its error bounds), equal to the scalar
+  versions up to FMA contraction.
+
+  applySinCos() shares one reduction between sin and cos of the same
+  argument and returns the same values as the separate (exact or fast)
+  kernels.
+  applyMulAdd() uses the FMA instruction, rounded once like std::fma.
+
+  ^, mod, ! and % stay scalar: pow needs an extended-precision logarithm to
+  stay within a few ulp and the others are rare in plotted expressions.
+*/
+class VectorMath {
+ public:
+  //! Instruction set of the kernels
+  enum class Isa { kScalar, kAvx2, kAvx512 };
+
+  static Isa getIsa();
+  static Isa getSupportedIsa();
+  static void setIsa(Isa isa);
+
+  static bool hasKernel(OpCode code);
+  static bool apply(OpCode code, double *column, std::size_t size);
+  static bool applySinCos(const double *column, double *sinColumn,
+                          double *cosColumn, std::size_t size,
+                          bool fast = false);
+  static bool applyMulAdd(double *column, const double *mColumn,
+                          const double *aColumn, std::size_t size);
+};
+
+}  // namespace s21
+
+#endif  // CPP3_SMARTCALC_V2_SRC_SMARTCALC_V2_MODEL_VECTORMATH_H_
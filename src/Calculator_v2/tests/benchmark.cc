@@ -0,0 +1,340 @@
+// Interpreter vs native code timings, the fast math speed/accuracy trade
+// and interval sampling of graphs, built by "make benchmark"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iterator>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../model/expressionParser.h"
+#include "../model/jitProgram.h"
+#include "../model/model.h"
+#include "../model/optimizer.h"
+
+namespace {
+
+constexpr std::size_t kPoints = 1000000;
+
+template <class Function>
+double milliseconds(Function function) {
+  auto start = std::chrono::steady_clock::now();
+  function();
+  std::chrono::duration<double, std::milli> time =
+      std::chrono::steady_clock::now() - start;
+  return time.count();
+}
+
+// 3x^4 - 2x^3 + x - 7, written with multiplications only
+s21::Program polynomial() {
+  s21::Program::Builder builder;
+  builder.pushConstant(3);
+  for (int i = 0; i < 4; ++i) {
+    builder.pushOperation(s21::OpCode::kPushX);
+    builder.pushOperation(s21::OpCode::kMul);
+  }
+  builder.pushConstant(2);
+  for (int i = 0; i < 3; ++i) {
+    builder.pushOperation(s21::OpCode::kPushX);
+    builder.pushOperation(s21::OpCode::kMul);
+  }
+  builder.pushOperation(s21::OpCode::kSub);
+  builder.pushOperation(s21::OpCode::kPushX);
+  builder.pushOperation(s21::OpCode::kAdd);
+  builder.pushConstant(7);
+  builder.pushOperation(s21::OpCode::kSub);
+  return builder.build();
+}
+
+// sin(x) * x / (1 + x * x) + cos(x)
+s21::Program trigonometric() {
+  s21::Program::Builder builder;
+  builder.pushOperation(s21::OpCode::kPushX);
+  builder.pushOperation(s21::OpCode::kSin);
+  builder.pushOperation(s21::OpCode::kPushX);
+  builder.pushOperation(s21::OpCode::kMul);
+  builder.pushConstant(1);
+  builder.pushOperation(s21::OpCode::kPushX);
+  builder.pushOperation(s21::OpCode::kPushX);
+  builder.pushOperation(s21::OpCode::kMul);
+  builder.pushOperation(s21::OpCode::kAdd);
+  builder.pushOperation(s21::OpCode::kDiv);
+  builder.pushOperation(s21::OpCode::kPushX);
+  builder.pushOperation(s21::OpCode::kCos);
+  builder.pushOperation(s21::OpCode::kAdd);
+  return builder.build();
+}
+
+void run(const char *name, const s21::Program &source) {
+  s21::Program program = s21::Optimizer::optimize(source);
+  s21::JitProgram jit(program);
+  std::vector<double> xs(kPoints), ys(kPoints);
+  std::vector<double> stack(program.getScratchSize());
+  for (std::size_t i = 0; i < kPoints; ++i) {
+    xs[i] = -10.0 + 20.0 * i / kPoints;
+  }
+  double sink = 0;
+  double scalar = milliseconds([&] {
+    for (double x : xs) sink += program.evaluate(x, stack.data());
+  });
+  double jitScalar = milliseconds([&] {
+    for (double x : xs) sink += jit.evaluate(x, stack.data());
+  });
+  double batch = milliseconds([&] { program.evaluate(xs, ys); });
+  double jitBatch = milliseconds([&] { jit.evaluate(xs, ys); });
+  std::printf(
+      "%-14s scalar %7.2f ms, jit %7.2f ms | batch %7.2f ms, jit %7.2f ms"
+      " (%s)\n",
+      name, scalar, jitScalar, batch, jitBatch,
+      jit.isCompiled() ? "native" : "fallback");
+  if (sink == 0.5) std::printf("\n");
+}
+
+// error in ulps of max(|exact|, 1), see the FastMath.AccuracyBudget test
+double scaledUlpError(double value, double exact) {
+  if (value == exact || (std::isnan(value) && std::isnan(exact))) {
+    return 0.0;
+  }
+  double scale = std::max(std::fabs(exact), 1.0);
+  return std::fabs(value - exact) / (std::nextafter(scale, INFINITY) - scale);
+}
+
+// random expression of x in [-10, 10] without poles, see the
+// FastMath.AccuracyBudget test
+std::string randomExpression(std::mt19937 &random, int depth) {
+  std::uniform_int_distribution<int> pick(0, depth > 0 ? 8 : 1);
+  auto operand = [&] { return randomExpression(random, depth - 1); };
+  switch (pick(random)) {
+    case 0:
+      return "x";
+    case 1:
+      return std::to_string(std::uniform_int_distribution<int>(1, 9)(random));
+    case 2:
+      return "sin(" + operand() + ")";
+    case 3:
+      return "cos(" + operand() + ")";
+    case 4:
+      return "atan(" + operand() + ")";
+    case 5:
+      return "ln(1 + (" + operand() + ")^2)";
+    case 6:
+      return "(" + operand() + " + " + operand() + ")";
+    case 7:
+      return "(" + operand() + ")*sin(" + operand() + ")";
+    default:
+      return "(" + operand() + ")/(2 + cos(" + operand() + "))";
+  }
+}
+
+// exact vs fast math graph of each expression on one thread, best of 5, then
+// the error over a seeded random corpus
+void fastMath() {
+  const char *corpus[] = {"sin(x)/3 + cos(x)/7",
+                          "x/10 + 1 + sin(x) + 2",
+                          "sin(2x) + cos(3x) - 1",
+                          "cos(x/4) * ln(x + 11)",
+                          "atan(x)/2 + ln(2 + sin(x))",
+                          "sin(x) + sin(x + 1) + sin(x + 2)",
+                          "tan(x/3) + sin(x)"};
+  s21::CalcModel exact, fast;
+  fast.setFastMathEnabled(true);
+  for (s21::CalcModel *model : {&exact, &fast}) {
+    model->setThreadCount(1);
+  }
+  const double step = 20.0 / kPoints;
+  std::printf("\nfast math, %zu points per run, error in ulps of max(|y|, 1)\n",
+              kPoints);
+  for (const char *expression : corpus) {
+    double exactTime = INFINITY, fastTime = INFINITY;
+    for (int run = 0; run < 5; ++run) {
+      exactTime = std::min(exactTime, milliseconds([&] {
+        exact.graphCalculate(expression, step, 10, -10, 1e300, -1e300);
+      }));
+      fastTime = std::min(fastTime, milliseconds([&] {
+        fast.graphCalculate(expression, step, 10, -10, 1e300, -1e300);
+      }));
+    }
+    std::vector<double> expected = exact.getGraph().second;
+    std::vector<double> ys = fast.getGraph().second;
+    double worst = 0, total = 0;
+    for (std::size_t i = 0; i < ys.size(); ++i) {
+      double error = scaledUlpError(ys[i], expected[i]);
+      worst = std::max(worst, error);
+      total += error;
+    }
+    std::printf("%-34s exact %6.2f ms, fast %6.2f ms | max %9.1f, mean %5.2f\n",
+                expression, exactTime, fastTime, worst, total / ys.size());
+  }
+  const int expressions = 1000;
+  std::mt19937 random(21);
+  double worst = 0, total = 0;
+  std::size_t points = 0;
+  for (int k = 0; k < expressions; ++k) {
+    std::string expression = randomExpression(random, 4);
+    exact.graphCalculate(expression, 0.01, 10, -10, 1e300, -1e300);
+    fast.graphCalculate(expression, 0.01, 10, -10, 1e300, -1e300);
+    std::vector<double> expected = exact.getGraph().second;
+    std::vector<double> ys = fast.getGraph().second;
+    for (std::size_t i = 0; i < ys.size(); ++i) {
+      if (!std::isnan(expected[i])) {
+        double error = scaledUlpError(ys[i], expected[i]);
+        worst = std::max(worst, error);
+        total += error;
+        ++points;
+      }
+    }
+  }
+  std::printf("%d random expressions, %zu points | max %9.1f, mean %5.2f\n",
+              expressions, points, worst, total / points);
+}
+
+// graph with and without interval sampling on one thread, best of 5: wide
+// x ranges where most of the curve is outside a [-10, 10] window
+// gate: the default graph path is at most kMaxSlowdown slower than plain
+// evaluation, false if not
+bool intervalSampling() {
+  const char *corpus[] = {"x^3 - 2x",     "tan(x)", "x^2 * sin(x)",
+                          "1/x + sin(x)", "ln(x)",  "sin(x)*cos(x)"};
+  const double kMaxSlowdown = 1.15;
+  s21::CalcModel sampled, plain, defaults;
+  sampled.setIntervalSamplingEnabled(true);
+  plain.setIntervalSamplingEnabled(false);
+  for (s21::CalcModel *model : {&sampled, &plain, &defaults}) {
+    model->setThreadCount(1);
+  }
+  const double step = 2000.0 / kPoints;
+  std::printf("\ninterval sampling, x in [-1000, 1000], y in [-10, 10]\n");
+  bool passed = true;
+  for (const char *expression : corpus) {
+    double plainTime = INFINITY, sampledTime = INFINITY;
+    double defaultTime = INFINITY;
+    for (int run = 0; run < 5; ++run) {
+      plainTime = std::min(plainTime, milliseconds([&] {
+        plain.graphCalculate(expression, step, 1000, -1000, 10, -10);
+      }));
+      sampledTime = std::min(sampledTime, milliseconds([&] {
+        sampled.graphCalculate(expression, step, 1000, -1000, 10, -10);
+      }));
+      defaultTime = std::min(defaultTime, milliseconds([&] {
+        defaults.graphCalculate(expression, step, 1000, -1000, 10, -10);
+      }));
+    }
+    std::size_t breaks =
+        sampled.getGraph().first.size() - plain.getGraph().first.size();
+    bool slow = defaultTime > plainTime * kMaxSlowdown;
+    passed = passed && !slow;
+    std::printf(
+        "%-34s plain %6.2f ms, sampled %6.2f ms | %zu breaks | default"
+        " %6.2f ms%s\n",
+        expression, plainTime, sampledTime, breaks, defaultTime,
+        slow ? " SLOWER THAN PLAIN" : "");
+  }
+  return passed;
+}
+
+// roots and extrema of many-root expressions, one thread vs the pool
+void criticalPoints() {
+  const char *corpus[] = {"sin(1000x)", "sin(1000x) * x^2 - x",
+                          "tan(100x)", "sin(x^2)"};
+  s21::CalcModel single, multi;
+  single.setThreadCount(1);
+  const double step = 20.0 / kPoints;
+  std::printf("\nroots and extrema, x in [-10, 10]\n");
+  for (const char *expression : corpus) {
+    double singleTime = INFINITY, multiTime = INFINITY;
+    for (int run = 0; run < 5; ++run) {
+      singleTime = std::min(singleTime, milliseconds([&] {
+        single.criticalPointsCalculate(expression, step, 10, -10);
+      }));
+      multiTime = std::min(multiTime, milliseconds([&] {
+        multi.criticalPointsCalculate(expression, step, 10, -10);
+      }));
+    }
+    std::printf("%-34s 1 thread %6.2f ms, %zu threads %6.2f ms | %zu points\n",
+                expression, singleTime, multi.getThreadCount(), multiTime,
+                multi.getCriticalPoints().size());
+  }
+}
+
+// adaptive quadrature vs the trapezoid sum of kPoints graph samples
+void integral() {
+  struct Case {
+    const char *expression;
+    double a, b, exact;
+  } corpus[] = {
+      {"sin(x) * x", 0, 1000, std::sin(1000.0) - 1000 * std::cos(1000.0)},
+      {"1 / sqrt(x)", 0, 100, 20},
+      {"ln(x)", 1, 1000, 1000 * std::log(1000.0) - 999},
+  };
+  s21::CalcModel model;
+  std::printf("\nintegrals, quadrature vs trapezoids on graph samples\n");
+  for (const Case &c : corpus) {
+    double step = (c.b - c.a) / kPoints;
+    double sum = 0;
+    double graphTime = milliseconds([&] {
+      model.graphCalculate(c.expression, step, c.b, c.a, 1e300, -1e300);
+      s21::CalcModel::GraphXY graph = model.getGraph();
+      for (std::size_t i = 1; i < graph.first.size(); ++i) {
+        double y0 = graph.second[i - 1], y1 = graph.second[i];
+        if (std::isfinite(y0) && std::isfinite(y1)) {
+          sum += (graph.first[i] - graph.first[i - 1]) * (y0 + y1) / 2;
+        }
+      }
+    });
+    double quadratureTime = milliseconds(
+        [&] { model.integralCalculate(c.expression, c.a, c.b); });
+    s21::Integral integral = model.getIntegral();
+    std::printf(
+        "%-34s graph %6.2f ms, error %.1e | quadrature %6.2f ms, error %.1e "
+        "(estimate %.1e, %zu evaluations)\n",
+        c.expression, graphTime, std::fabs(sum - c.exact), quadratureTime,
+        std::fabs(integral.value - c.exact), integral.error,
+        integral.evaluations);
+  }
+}
+
+// bulk validation with half of the inputs malformed, exceptions vs Expected
+void validation() {
+  const char *corpus[] = {"sin(x) * x + 2", "x+2y",          "ln(x) / (x - 1)",
+                          "5 / 0",          "(3 + 3.2) ^ x", "82039.23 /"};
+  constexpr std::size_t kInputs = 100000;
+  std::size_t thrown = 0, returned = 0;
+  double throwTime = milliseconds([&] {
+    s21::ExpressionParser parser;
+    for (std::size_t i = 0; i < kInputs; ++i) {
+      try {
+        parser.parse(corpus[i % std::size(corpus)]);
+      } catch (std::logic_error &) {
+        ++thrown;
+      }
+    }
+  });
+  double expectedTime = milliseconds([&] {
+    s21::ExpressionParser parser;
+    for (std::size_t i = 0; i < kInputs; ++i) {
+      returned += !parser.tryParse(corpus[i % std::size(corpus)]);
+    }
+  });
+  std::printf("\nvalidation of %zu inputs\n", kInputs);
+  std::printf(
+      "%-34s logic_error %6.2f ms, Expected %6.2f ms | %zu, %zu errors\n",
+      "half malformed", throwTime, expectedTime, thrown, returned);
+}
+
+}  // namespace
+
+int main() {
+  std::printf("%zu points per run\n", kPoints);
+  run("polynomial", polynomial());
+  run("trigonometric", trigonometric());
+  fastMath();
+  bool passed = intervalSampling();
+  criticalPoints();
+  integral();
+  validation();
+  return passed ? 0 : 1;
+}
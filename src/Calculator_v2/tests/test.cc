@@ -1,6 +1,17 @@
 #include <gtest/gtest.h>
 
+#include <cstring>
+#include <random>
+#include <thread>
+
+#include "../model/depositModel.h"
+#include "../model/dualMath.h"
+#include "../model/fastMath.h"
+#include "../model/intervalMath.h"
+#include "../model/jitProgram.h"
 #include "../model/model.h"
+#include "../model/optimizer.h"
+#include "../model/vectorMath.h"
 
 TEST(ThrowError, ThrowError1) {
   s21::CalcModel model;
@@ -57,6 +68,75 @@ TEST(ThrowError, ThrowError10) {
   EXPECT_ANY_THROW(model.modelCalculate("-1000-", NAN));
 }
 
+TEST(Expected, ErrorCodes) {
+  struct Case {
+    std::string expression;
+    s21::ErrorCode code;
+    std::size_t position;
+  };
+  const std::vector<Case> cases = {
+      {"x+2y", s21::ErrorCode::kIncorrectInput, 3},
+      {"", s21::ErrorCode::kEmptyExpression, 0},
+      {"3x + 4.0432 // tan(3.12)", s21::ErrorCode::kWrongSequence, 13},
+      {"5 / 0", s21::ErrorCode::kDivisionByZero, 4},
+      {"* 932.932", s21::ErrorCode::kWrongFirstToken, 0},
+      {"82039.23 /", s21::ErrorCode::kWrongLastToken, 9},
+      {"(3 + 3.2))", s21::ErrorCode::kUnbalancedBrackets, 9},
+  };
+  s21::CalcModel model;
+  for (const Case &c : cases) {
+    s21::Expected<double> result = model.tryCalculate(c.expression, 0.0);
+    ASSERT_FALSE(result) << c.expression;
+    EXPECT_EQ(c.code, result.error().code) << c.expression;
+    EXPECT_EQ(c.position, result.error().position) << c.expression;
+    try {
+      model.modelCalculate(c.expression, 0.0);
+      ADD_FAILURE() << c.expression;
+    } catch (std::logic_error &e) {
+      EXPECT_EQ(result.error().message(), e.what());
+    }
+  }
+  EXPECT_EQ("Incorrect input: y",
+            model.tryCalculate("x+2Y", 0.0).error().message());
+  EXPECT_EQ(-1, model.tryCalculate("(3 + 3.2))", 0.0).error().count);
+  EXPECT_FALSE(s21::CompiledExpression::create("sin(x"));
+}
+
+TEST(Expected, Value) {
+  s21::CalcModel model;
+  s21::Expected<double> result = model.tryCalculate("x ", 2.0);
+  ASSERT_TRUE(result);
+  EXPECT_DOUBLE_EQ(2.0, result.value());
+  EXPECT_EQ(s21::ErrorCode::kNone, result.error().code);
+  EXPECT_DOUBLE_EQ(2.0, model.getResult());
+  EXPECT_FALSE(model.tryCalculate("x*+", 2.0));
+  s21::Expected<s21::CompiledExpression> compiled =
+      model.tryCompileExpression("2x");
+  ASSERT_TRUE(compiled);
+  s21::CompiledExpression::Context context;
+  EXPECT_DOUBLE_EQ(6.0, compiled.value().evaluate(3.0, context));
+}
+
+TEST(Expected, Withdrawal) {
+  s21::DepositModel deposit;
+  std::vector<double> replenishs;
+  std::vector<double> withdrawals(400, 0.0);
+  withdrawals[5] = 2000.0;
+  s21::Expected<double> result = deposit.tryCalcDeposit(
+      1000.0, 12, 5.0, 13.0, 1, false, replenishs, withdrawals);
+  ASSERT_FALSE(result);
+  EXPECT_EQ(s21::ErrorCode::kWithdrawalExceedsAmount, result.error().code);
+  EXPECT_EQ(5u, result.error().position);
+  EXPECT_THROW(deposit.calcDeposit(1000.0, 12, 5.0, 13.0, 1, false,
+                                   replenishs, withdrawals),
+               std::logic_error);
+  withdrawals[5] = 0.0;
+  result = deposit.tryCalcDeposit(1000.0, 12, 5.0, 13.0, 1, false, replenishs,
+                                  withdrawals);
+  ASSERT_TRUE(result);
+  EXPECT_DOUBLE_EQ(deposit.getTotalAmount(), result.value());
+}
+
 TEST(Calculate, Calculate1) {
   std::string expression = "sin(4 + 2) + cos(0.3)";
   s21::CalcModel model;
@@ -137,6 +217,1409 @@ TEST(Calculate, Calculate11) {
   EXPECT_DOUBLE_EQ(tgamma(10 + 1), model.getResult());
 }
 
+TEST(Parse, Exponent) {
+  s21::CalcModel model;
+  model.modelCalculate("1.5e3 + 2E-2 - 4e+1", NAN);
+  EXPECT_DOUBLE_EQ(1.5e3 + 2e-2 - 4e+1, model.getResult());
+}
+
+TEST(Parse, UpperCase) {
+  s21::CalcModel model;
+  model.modelCalculate("SIN(X) + Cos(2X)", 0.5);
+  EXPECT_DOUBLE_EQ(sin(0.5) + cos(2 * 0.5), model.getResult());
+}
+
+TEST(Parse, IncompleteExponent) {
+  s21::CalcModel model;
+  try {
+    model.modelCalculate("2e+", 0.0);
+    FAIL();
+  } catch (std::exception &e) {
+    EXPECT_STREQ("Incorrect input: e", e.what());
+  }
+  EXPECT_ANY_THROW(model.modelCalculate("2.", 0.0));
+}
+
+TEST(Parse, Overflow) {
+  s21::CalcModel model;
+  model.modelCalculate("1e999", NAN);
+  EXPECT_TRUE(std::isinf(model.getResult()));
+}
+
+TEST(TokenTable, Find) {
+  const s21::Token *token = s21::TokenTable::find("SqRt");
+  ASSERT_NE(nullptr, token);
+  EXPECT_EQ("sqrt", token->getName());
+  EXPECT_EQ(s21::OpCode::kSqrt, token->getOpCode());
+  EXPECT_EQ("space", s21::TokenTable::find(" ")->getName());
+  EXPECT_EQ(nullptr, s21::TokenTable::find("sinh"));
+  EXPECT_EQ(nullptr, s21::TokenTable::find("~"));
+  EXPECT_EQ(nullptr, s21::TokenTable::find(""));
+}
+
+TEST(Cache, HitMiss) {
+  s21::CalcModel model;
+  model.modelCalculate("sin(x) + 1", 0.5);
+  model.modelCalculate("SIN(x)  + 1", 1.5);
+  EXPECT_DOUBLE_EQ(sin(1.5) + 1, model.getResult());
+  model.graphCalculate("sin(x) + 1", 0.5, 5, -5, 100, -100);
+  model.graphCalculate("sin(x) + 1", 0.5, 5, -5, 100, -100);
+  // long double programs fold constants in long double
+  EXPECT_EQ(2u, model.getCache().getMisses());
+  EXPECT_EQ(2u, model.getCache().getHits());
+  EXPECT_EQ(2u, model.getCache().getSize());
+  EXPECT_ANY_THROW(model.modelCalculate("sin(x) +", 0.5));
+  EXPECT_EQ(2u, model.getCache().getSize());
+}
+
+TEST(Cache, Eviction) {
+  s21::ExpressionCache cache(2);
+  auto program = std::make_shared<const s21::Program>();
+  cache.insert("a", program);
+  cache.insert("b", program);
+  EXPECT_NE(nullptr, cache.find("a"));
+  cache.insert("c", program);
+  EXPECT_EQ(nullptr, cache.find("b"));
+  EXPECT_NE(nullptr, cache.find("a"));
+  EXPECT_NE(nullptr, cache.find("c"));
+  EXPECT_EQ(2u, cache.getSize());
+  EXPECT_EQ("2 * x", s21::ExpressionCache::normalize("2   *  X"));
+}
+
+TEST(CompiledExpression, Evaluate) {
+  s21::CalcModel model;
+  const std::string expression = "sin(x) * x^2 - ln(x + 11) / 3";
+  s21::CompiledExpression compiled = model.compileExpression(expression);
+  s21::CompiledExpression parsed(expression);
+  s21::CompiledExpression::Context context;
+  for (double x = -5; x < 5; x += 0.25) {
+    for (s21::Precision precision :
+         {s21::Precision::kFloat, s21::Precision::kDouble,
+          s21::Precision::kLongDouble}) {
+      model.modelCalculate(expression, x, precision);
+      EXPECT_EQ(model.getResult(), compiled.evaluate(x, context, precision));
+      EXPECT_EQ(model.getResult(), parsed.evaluate(x, context, precision));
+    }
+    model.modelDifferentiate(expression, x);
+    EXPECT_EQ(model.getDerivative(),
+              compiled.differentiate(x, context).derivative);
+  }
+  // the long double program and the double one
+  EXPECT_EQ(2u, model.getCache().getMisses());
+  EXPECT_ANY_THROW(s21::CompiledExpression("x +"));
+  try {
+    s21::CompiledExpression("x+2y");
+    FAIL();
+  } catch (std::exception &e) {
+    EXPECT_STREQ("Incorrect input: y", e.what());
+  }
+}
+
+TEST(CompiledExpression, SharedByThreads) {
+  // one compiled expression, a context per thread, no locks
+  const s21::CompiledExpression compiled("x^3 - 2x + cos(x) * x mod 3");
+  std::vector<double> xs(10000), expected(xs.size());
+  for (size_t i = 0; i < xs.size(); ++i) {
+    xs[i] = -50 + 0.01 * i;
+  }
+  s21::CompiledExpression::Context context;
+  compiled.evaluate(xs, expected, context);
+  std::vector<std::vector<double>> points(8, std::vector<double>(xs.size()));
+  std::vector<std::vector<double>> batches(points);
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < points.size(); ++t) {
+    threads.emplace_back([&, t] {
+      s21::CompiledExpression::Context local;
+      for (size_t i = 0; i < xs.size(); ++i) {
+        points[t][i] =
+            compiled.evaluate(xs[i], local, s21::Precision::kDouble);
+      }
+      compiled.evaluate(xs, batches[t], local);
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  for (size_t t = 0; t < points.size(); ++t) {
+    EXPECT_EQ(0, std::memcmp(expected.data(), batches[t].data(),
+                             xs.size() * sizeof(double)));
+    for (size_t i = 0; i < xs.size(); ++i) {
+      EXPECT_NEAR(expected[i], points[t][i],
+                  1e-12 * std::max(1.0, std::abs(expected[i])));
+    }
+  }
+}
+
+TEST(Program, StackDepth) {
+  s21::Program::Builder builder;
+  builder.pushConstant(2.0);
+  builder.pushOperation(s21::OpCode::kPushX);
+  builder.pushConstant(3.0);
+  builder.pushOperation(s21::OpCode::kPow);
+  builder.pushOperation(s21::OpCode::kMul);
+  s21::Program program = builder.build();
+  std::vector<double> stack(program.getStackDepth());
+  EXPECT_EQ(3u, program.getStackDepth());
+  EXPECT_EQ(5u, program.getSize());
+  EXPECT_DOUBLE_EQ(2.0 * pow(1.5, 3), program.evaluate(1.5, stack.data()));
+}
+
+TEST(Program, Precision) {
+  // 2^0.5 is folded in double at compile time
+  s21::CalcModel model;
+  model.modelCalculate("sin(x) + 2^0.5", 1.0, s21::Precision::kFloat);
+  EXPECT_EQ(static_cast<double>(sinf(1.0f) + static_cast<float>(M_SQRT2)),
+            model.getResult());
+  model.modelCalculate("sin(x) + 2^0.5", 1.0, s21::Precision::kDouble);
+  EXPECT_EQ(sin(1.0) + M_SQRT2, model.getResult());
+  model.modelCalculate("sin(x) + 2^0.5", 1.0);
+  EXPECT_EQ(static_cast<double>(
+                static_cast<double>(sinl(1.0L)) +
+                static_cast<long double>(static_cast<double>(sqrtl(2.0L)))),
+            model.getResult());
+  model.graphCalculate("ln(x)", 0.5, 5, 0.5, 100, -100,
+                       s21::Precision::kFloat);
+  s21::CalcModel::GraphXY graph = model.getGraph();
+  ASSERT_EQ(8u, graph.second.size());
+  for (size_t i = 0; i < graph.first.size(); ++i) {
+    float x = static_cast<float>(graph.first[i]);
+    EXPECT_TRUE(x == 1.0f || logf(x) == graph.second[i]);
+  }
+}
+
+TEST(Program, Unbalanced) {
+  s21::Program::Builder builder;
+  builder.pushConstant(2.0);
+  EXPECT_ANY_THROW(builder.pushOperation(s21::OpCode::kAdd));
+}
+
+TEST(Program, Batch) {
+  s21::Program::Builder builder;
+  builder.pushOperation(s21::OpCode::kPushX);
+  builder.pushOperation(s21::OpCode::kSin);
+  builder.pushConstant(3.0);
+  builder.pushOperation(s21::OpCode::kPushX);
+  builder.pushOperation(s21::OpCode::kMul);
+  builder.pushOperation(s21::OpCode::kFactorial);
+  builder.pushOperation(s21::OpCode::kDiv);
+  s21::Program program = builder.build();
+  std::vector<double> xs(1000), ys(1000), stack(program.getStackDepth());
+  for (size_t i = 0; i < xs.size(); ++i) {
+    xs[i] = -5.0 + 0.01 * i;
+  }
+  s21::VectorMath::Isa isa = s21::VectorMath::getIsa();
+  s21::VectorMath::setIsa(s21::VectorMath::Isa::kScalar);
+  program.evaluate(xs, ys);
+  s21::VectorMath::setIsa(isa);
+  for (size_t i = 0; i < xs.size(); ++i) {
+    double expected = program.evaluate(xs[i], stack.data());
+    EXPECT_TRUE(expected == ys[i] ||
+                (std::isnan(expected) && std::isnan(ys[i])));
+  }
+  EXPECT_ANY_THROW(program.evaluate(xs, std::span<double>(ys).first(10)));
+}
+
+// distance to the exact (long double) value in ulps of the double result
+static double ulpError(double value, long double exact) {
+  if (value == exact || (std::isnan(value) && std::isnan(exact))) {
+    return 0.0;
+  }
+  double rounded = std::fabs(static_cast<double>(exact));
+  double ulp = std::nextafter(rounded, INFINITY) - rounded;
+  return static_cast<double>(std::fabs(value - exact) / ulp);
+}
+
+TEST(VectorMath, ErrorBounds) {
+  struct Case {
+    s21::OpCode code;
+    long double (*exact)(long double);
+    double min, max, maxUlp;
+  };
+  const Case cases[] = {{s21::OpCode::kSin, sinl, -1e6, 1e6, 1.6},
+                        {s21::OpCode::kCos, cosl, -1e4, 1e4, 1.6},
+                        {s21::OpCode::kTan, tanl, -100, 100, 3.5},
+                        {s21::OpCode::kAtan, atanl, -50, 50, 1.0},
+                        {s21::OpCode::kAsin, asinl, -1, 1, 2.5},
+                        {s21::OpCode::kAcos, acosl, -1, 1, 2.0},
+                        {s21::OpCode::kLn, logl, 0, 1e6, 1.0},
+                        {s21::OpCode::kLog, log10l, 0.5, 2, 2.0},
+                        {s21::OpCode::kSqrt, sqrtl, 0, 1e6, 0.5}};
+  s21::VectorMath::Isa supported = s21::VectorMath::getSupportedIsa();
+  std::mt19937_64 generator(21);
+  for (int isa = 0; isa <= static_cast<int>(supported); ++isa) {
+    s21::VectorMath::setIsa(static_cast<s21::VectorMath::Isa>(isa));
+    for (const Case &test : cases) {
+      std::uniform_real_distribution<double> distribution(test.min, test.max);
+      std::vector<double> xs(100003);
+      for (double &x : xs) {
+        x = distribution(generator);
+      }
+      std::vector<double> ys = xs;
+      bool vectorized = s21::VectorMath::apply(test.code, ys.data(), ys.size());
+      EXPECT_EQ(isa != 0, vectorized);
+      for (size_t i = 0; vectorized && i < xs.size(); ++i) {
+        ASSERT_LE(ulpError(ys[i], test.exact(xs[i])), test.maxUlp) << xs[i];
+      }
+    }
+  }
+  s21::VectorMath::setIsa(supported);
+}
+
+TEST(VectorMath, SpecialValues) {
+  std::vector<double> xs = {0.0, -0.0, INFINITY, -INFINITY, NAN, 1e300,
+                            -1.0, 2.0, 4.9e-324, 1.0};
+  const s21::OpCode codes[] = {s21::OpCode::kSin,  s21::OpCode::kTan,
+                               s21::OpCode::kAsin, s21::OpCode::kAcos,
+                               s21::OpCode::kAtan, s21::OpCode::kLn,
+                               s21::OpCode::kLog,  s21::OpCode::kSqrt};
+  for (s21::OpCode code : codes) {
+    std::vector<double> ys = xs;
+    s21::VectorMath::apply(code, ys.data(), ys.size());
+    for (size_t i = 0; i < xs.size(); ++i) {
+      double exact = s21::Program::applyUnary(code, xs[i]);
+      EXPECT_TRUE(std::isnan(exact) == std::isnan(ys[i]) &&
+                  (std::isnan(exact) || ulpError(ys[i], exact) <= 3.5))
+          << static_cast<int>(code) << " " << xs[i];
+    }
+  }
+}
+
+TEST(Optimizer, FoldConstants) {
+  // sin(2) * cos(0.3) * x + sqrt(17)
+  s21::Program::Builder builder;
+  builder.pushConstant(2);
+  builder.pushOperation(s21::OpCode::kSin);
+  builder.pushConstant(0.3);
+  builder.pushOperation(s21::OpCode::kCos);
+  builder.pushOperation(s21::OpCode::kMul);
+  builder.pushOperation(s21::OpCode::kPushX);
+  builder.pushOperation(s21::OpCode::kMul);
+  builder.pushConstant(17);
+  builder.pushOperation(s21::OpCode::kSqrt);
+  builder.pushOperation(s21::OpCode::kAdd);
+  s21::Program program = builder.build();
+  s21::Program folded = s21::Optimizer::foldConstants(program);
+  EXPECT_EQ(5u, folded.getSize());
+  std::vector<double> stack(program.getStackDepth());
+  for (double x : {-2.5, 0.0, 1.0, 1e10, std::nan("")}) {
+    double expected = program.evaluate(x, stack.data());
+    double result = folded.evaluate(x, stack.data());
+    EXPECT_TRUE(expected == result ||
+                (std::isnan(expected) && std::isnan(result)));
+  }
+  // long double evaluation rounds like the folded constants
+  for (double x : {-2.5, 0.0, 1.0, 1e10, std::nan("")}) {
+    std::vector<long double> longStack(program.getStackDepth());
+    double expected = program.evaluate<long double>(x, longStack.data());
+    double result =
+        s21::Optimizer::foldConstants(program, s21::Precision::kLongDouble)
+            .evaluate<long double>(x, longStack.data());
+    EXPECT_TRUE(expected == result ||
+                (std::isnan(expected) && std::isnan(result)));
+  }
+  s21::CalcModel model;
+  for (s21::Precision precision :
+       {s21::Precision::kFloat, s21::Precision::kDouble,
+        s21::Precision::kLongDouble}) {
+    model.modelCalculate("x/3+1/3", -1, precision);
+    EXPECT_EQ(0.0, model.getResult());
+  }
+  EXPECT_EQ(0.0, model.tryCalculate("x/3+1/3", -1).value());
+  s21::CompiledExpression::Context context;
+  EXPECT_EQ(0.0, model.compileExpression("x/3+1/3").evaluate(-1, context));
+  EXPECT_EQ(0.0, s21::CompiledExpression("x/3+1/3").evaluate(-1, context));
+}
+
+TEST(Optimizer, FoldErrors) {
+  // 1 / (1 - 1) + (0 - 3)! + x
+  s21::Program::Builder builder;
+  builder.pushConstant(1);
+  builder.pushConstant(1);
+  builder.pushConstant(1);
+  builder.pushOperation(s21::OpCode::kSub);
+  builder.pushOperation(s21::OpCode::kDiv);
+  builder.pushConstant(0);
+  builder.pushConstant(3);
+  builder.pushOperation(s21::OpCode::kSub);
+  builder.pushOperation(s21::OpCode::kFactorial);
+  builder.pushOperation(s21::OpCode::kAdd);
+  builder.pushOperation(s21::OpCode::kPushX);
+  builder.pushOperation(s21::OpCode::kAdd);
+  s21::Program folded = s21::Optimizer::foldConstants(builder.build());
+  std::vector<double> stack(folded.getStackDepth());
+  EXPECT_EQ(3u, folded.getSize());
+  EXPECT_TRUE(std::isnan(folded.getConstant(0)));
+  EXPECT_TRUE(std::isnan(folded.evaluate(1.0, stack.data())));
+}
+
+TEST(Optimizer, CommonSubexpressions) {
+  s21::CalcModel model;
+  model.modelCalculate("sin(x)^2 + sin(x)*cos(x) + cos(x)^2", 0.7);
+  EXPECT_DOUBLE_EQ(1.0 + sin(0.7) * cos(0.7), model.getResult());
+  // two repeated calls and the copies of sin(x) * sin(x), cos(x) * cos(x)
+  EXPECT_EQ(4u, model.getOptimizerReport().deduplicatedNodes);
+  // (x + 1) * sin(x + 1) + (1 + x) * sin(1 + x)
+  s21::Program::Builder builder;
+  for (int i = 0; i < 2; ++i) {
+    builder.pushOperation(s21::OpCode::kPushX);
+    builder.pushConstant(1);
+    builder.pushOperation(s21::OpCode::kAdd);
+    builder.pushOperation(s21::OpCode::kPushX);
+    builder.pushConstant(1);
+    builder.pushOperation(s21::OpCode::kAdd);
+    builder.pushOperation(s21::OpCode::kSin);
+    builder.pushOperation(s21::OpCode::kMul);
+  }
+  builder.pushOperation(s21::OpCode::kAdd);
+  s21::Program program = builder.build();
+  size_t deduplicated = 0;
+  s21::Program shared =
+      s21::Optimizer::eliminateCommonSubexpressions(program, &deduplicated);
+  EXPECT_EQ(5u, deduplicated);
+  EXPECT_EQ(2u, shared.getTemporaryCount());
+  EXPECT_EQ(10u, shared.getSize());
+  std::vector<double> xs(1000), ys(1000), expected(1000);
+  std::vector<double> stack(shared.getScratchSize());
+  for (size_t i = 0; i < xs.size(); ++i) {
+    xs[i] = -50.0 + 0.1 * i;
+  }
+  program.evaluate(xs, expected);
+  shared.evaluate(xs, ys);
+  for (size_t i = 0; i < xs.size(); ++i) {
+    EXPECT_EQ(program.evaluate(xs[i], stack.data()),
+              shared.evaluate(xs[i], stack.data()));
+    EXPECT_EQ(expected[i], ys[i]);
+  }
+}
+
+TEST(Optimizer, Powers) {
+  s21::CalcModel model;
+  model.modelCalculate("(x+1)^5 - 2/(x+1)^-3 + x^0.5", 1.5);
+  EXPECT_NEAR(pow(2.5, 5) - 2 * pow(2.5, 3) + sqrt(1.5), model.getResult(),
+              1e-12);
+  EXPECT_EQ(2u, model.getOptimizerReport().powers);
+  // (x+1)^5 = ((x+1)^2)^2 * (x+1), (x+1)^3 shares the square
+  std::vector<double> xs = {0.0, -1.0, 1e200, NAN, -INFINITY};
+  for (double x : xs) {
+    model.modelCalculate("(x+1)^5 - 2/(x+1)^-3", x, s21::Precision::kDouble);
+    double expected = pow(x + 1, 5) - 2 / pow(x + 1, -3);
+    EXPECT_TRUE(expected == model.getResult() ||
+                (std::isnan(expected) && std::isnan(model.getResult())))
+        << x;
+  }
+}
+
+TEST(Optimizer, Horner) {
+  s21::CalcModel model;
+  model.modelCalculate("3x^4 - 2x^3 + x - 7", 1.25);
+  EXPECT_DOUBLE_EQ(3 * pow(1.25, 4) - 2 * pow(1.25, 3) + 1.25 - 7,
+                   model.getResult());
+  EXPECT_EQ(1u, model.getOptimizerReport().polynomials);
+  EXPECT_EQ(0u, model.getOptimizerReport().powers);
+  // products of sums are kept, x^2 + x is rewritten
+  model.modelCalculate("(x - 1)(x + 1) + sin(x^2 + x)", 2);
+  EXPECT_DOUBLE_EQ(3 + sin(6), model.getResult());
+  EXPECT_EQ(1u, model.getOptimizerReport().polynomials);
+  // 3x^4 - 2x^3 + x - 7 = (((3x - 2)x)x + 1)x - 7
+  s21::Program::Builder builder;
+  builder.pushConstant(3);
+  builder.pushOperation(s21::OpCode::kPushX);
+  builder.pushConstant(4);
+  builder.pushOperation(s21::OpCode::kPow);
+  builder.pushOperation(s21::OpCode::kMul);
+  builder.pushConstant(2);
+  builder.pushOperation(s21::OpCode::kPushX);
+  builder.pushConstant(3);
+  builder.pushOperation(s21::OpCode::kPow);
+  builder.pushOperation(s21::OpCode::kMul);
+  builder.pushOperation(s21::OpCode::kSub);
+  builder.pushOperation(s21::OpCode::kPushX);
+  builder.pushOperation(s21::OpCode::kAdd);
+  builder.pushConstant(7);
+  builder.pushOperation(s21::OpCode::kSub);
+  s21::Program horner = s21::Optimizer::hornerPolynomials(builder.build());
+  EXPECT_EQ(15u, horner.getSize());
+  for (const s21::Instruction &instruction : horner.getCode()) {
+    EXPECT_NE(s21::OpCode::kPow, instruction.code);
+  }
+  // kept as written: merged coefficients overflow, written terms cancel
+  struct Case {
+    const char *expression;
+    double x, expected;
+  } cases[] = {
+      {"1e308*x^2 + 1e308*x^2 + x", 0, 0},
+      {"1e308*x^2 + 1e308*x^2 + x", 1e-200, 1e-200},
+      {"1e308*x^3+1e308*x^3", 0, 0},
+      {"0*x + x^2", INFINITY, NAN},
+      {"0*x + x^2", -INFINITY, NAN},
+      {"0*x^2 + x^2 + x", INFINITY, NAN},
+      {"0*x^2 + x^2 + x", -INFINITY, NAN},
+      {"x^2 + x - x", INFINITY, NAN},
+      // Horner form, see Optimizer: inf where the written form is NaN
+      {"x^2 + x", -INFINITY, INFINITY},
+  };
+  for (const Case &c : cases) {
+    model.modelCalculate(c.expression, c.x, s21::Precision::kDouble);
+    if (std::isnan(c.expected)) {
+      EXPECT_TRUE(std::isnan(model.getResult())) << c.expression;
+    } else {
+      EXPECT_EQ(c.expected, model.getResult()) << c.expression;
+    }
+  }
+  s21::CalcModel kept;
+  kept.modelCalculate("0*x^2 + x^2 + x", 2);
+  EXPECT_EQ(0u, kept.getOptimizerReport().polynomials);
+  // zero results are +0 like the written sums, not (x + 1) * x = -0
+  for (const char *expression : {"x^2+x", "x^3-x", "2*x^2+2*x"}) {
+    for (s21::Precision precision :
+         {s21::Precision::kDouble, s21::Precision::kLongDouble}) {
+      model.modelCalculate(expression, -1, precision);
+      EXPECT_EQ(0.0, model.getResult()) << expression;
+      EXPECT_FALSE(std::signbit(model.getResult())) << expression;
+    }
+    // and in batch evaluation
+    double x = -1, y = NAN;
+    s21::CompiledExpression::Context context;
+    s21::CompiledExpression(expression).evaluate({&x, 1}, {&y, 1}, context);
+    EXPECT_EQ(0.0, y) << expression;
+    EXPECT_FALSE(std::signbit(y)) << expression;
+  }
+}
+
+TEST(Optimizer, Superinstructions) {
+  s21::CalcModel model;
+  model.modelCalculate("3x^4 - 2x^3 + x - 7", 1.25);
+  EXPECT_DOUBLE_EQ(3 * pow(1.25, 4) - 2 * pow(1.25, 3) + 1.25 - 7,
+                   model.getResult());
+  s21::Optimizer::Report report = model.getOptimizerReport();
+  EXPECT_EQ(15u, report.instructionsBefore);
+  EXPECT_LT(report.instructionsAfter, report.instructionsBefore);
+  EXPECT_LT(0u, report.fusedInstructions);
+  model.modelCalculate("sin(x) * cos(x) + sin(x)", 0.5);
+  EXPECT_DOUBLE_EQ(sin(0.5) * cos(0.5) + sin(0.5), model.getResult());
+  // one kSinCos and one kMulAdd
+  EXPECT_EQ(2u, model.getOptimizerReport().fusedInstructions);
+  // sin(x) * cos(x) * x + 3
+  s21::Program::Builder builder;
+  builder.pushOperation(s21::OpCode::kPushX);
+  builder.pushOperation(s21::OpCode::kSin);
+  builder.pushOperation(s21::OpCode::kPushX);
+  builder.pushOperation(s21::OpCode::kCos);
+  builder.pushOperation(s21::OpCode::kMul);
+  builder.pushOperation(s21::OpCode::kPushX);
+  builder.pushOperation(s21::OpCode::kMul);
+  builder.pushConstant(3);
+  builder.pushOperation(s21::OpCode::kAdd);
+  s21::Program plain = builder.build();
+  s21::Program fused = s21::Optimizer::optimize(plain, &report);
+  EXPECT_EQ(9u, report.instructionsBefore);
+  EXPECT_EQ(6u, report.instructionsAfter);
+  EXPECT_EQ(fused.getSize(), report.instructionsAfter);
+  EXPECT_EQ(1u, fused.getTemporaryCount());
+  bool sinCos = false, mulAdd = false;
+  for (const s21::Instruction &instruction : fused.getCode()) {
+    sinCos |= instruction.code == s21::OpCode::kSinCos;
+    mulAdd |= instruction.code == s21::OpCode::kMulXAdd ||
+              instruction.code == s21::OpCode::kMulAdd;
+  }
+  EXPECT_TRUE(sinCos);
+  EXPECT_TRUE(mulAdd);
+  std::vector<double> xs(600), ys(600), expected(600);
+  std::vector<double> stack(fused.getScratchSize());
+  std::vector<double> plainStack(plain.getScratchSize());
+  for (size_t i = 0; i < xs.size(); ++i) {
+    xs[i] = -30.0 + 0.1 * i;
+  }
+  xs[5] = NAN;
+  fused.evaluate(xs, ys);
+  s21::JitProgram jit(fused);
+  jit.evaluate(xs, expected);
+  for (size_t i = 0; i < xs.size(); ++i) {
+    double value = plain.evaluate(xs[i], plainStack.data());
+    double result = fused.evaluate(xs[i], stack.data());
+    if (std::isnan(value)) {
+      EXPECT_TRUE(std::isnan(result) && std::isnan(ys[i]));
+      continue;
+    }
+    EXPECT_NEAR(value, result, 1e-12 * (1 + std::fabs(value)));
+    EXPECT_NEAR(value, ys[i], 1e-12 * (1 + std::fabs(value)));
+    EXPECT_EQ(result, jit.evaluate(xs[i], stack.data()));
+    EXPECT_EQ(ys[i], expected[i]);
+  }
+}
+
+TEST(FastMath, Kernels) {
+  struct Case {
+    s21::OpCode code;
+    long double (*exact)(long double);
+    double min, max, maxUlp;
+  };
+  const Case cases[] = {{s21::OpCode::kFastSin, sinl, -1e6, 1e6, 40},
+                        {s21::OpCode::kFastCos, cosl, -1e4, 1e4, 40}};
+  std::mt19937_64 generator(14);
+  for (const Case &test : cases) {
+    std::uniform_real_distribution<double> distribution(test.min, test.max);
+    std::vector<double> xs(100003);
+    for (double &x : xs) {
+      x = distribution(generator);
+    }
+    std::vector<double> ys = xs;
+    bool vectorized = s21::VectorMath::apply(test.code, ys.data(), ys.size());
+    for (size_t i = 0; i < xs.size(); ++i) {
+      long double exact = test.exact(xs[i]);
+      ASSERT_LE(ulpError(s21::Program::applyUnary(test.code, xs[i]), exact),
+                test.maxUlp)
+          << xs[i];
+      ASSERT_TRUE(!vectorized || ulpError(ys[i], exact) <= test.maxUlp)
+          << xs[i];
+    }
+  }
+  EXPECT_TRUE(std::isnan(s21::FastMath::sin(INFINITY)));
+  EXPECT_EQ(sin(1e300), s21::FastMath::sin(1e300));
+}
+
+// error in ulps of max(|exact|, 1): relative for |y| >= 1, absolute below,
+// so results cancelling to zero do not dominate
+static double scaledUlpError(double value, double exact) {
+  if (value == exact || (std::isnan(value) && std::isnan(exact))) {
+    return 0.0;
+  }
+  double scale = std::max(std::fabs(exact), 1.0);
+  return std::fabs(value - exact) / (std::nextafter(scale, INFINITY) - scale);
+}
+
+// random expression of x in [-10, 10] without poles: bounded functions,
+// sums, products with a sine and quotients by 2 + cos
+static std::string randomExpression(std::mt19937 &random, int depth) {
+  std::uniform_int_distribution<int> pick(0, depth > 0 ? 8 : 1);
+  auto operand = [&] { return randomExpression(random, depth - 1); };
+  switch (pick(random)) {
+    case 0:
+      return "x";
+    case 1:
+      return std::to_string(std::uniform_int_distribution<int>(1, 9)(random));
+    case 2:
+      return "sin(" + operand() + ")";
+    case 3:
+      return "cos(" + operand() + ")";
+    case 4:
+      return "atan(" + operand() + ")";
+    case 5:
+      return "ln(1 + (" + operand() + ")^2)";
+    case 6:
+      return "(" + operand() + " + " + operand() + ")";
+    case 7:
+      return "(" + operand() + ")*sin(" + operand() + ")";
+    default:
+      return "(" + operand() + ")/(2 + cos(" + operand() + "))";
+  }
+}
+
+TEST(FastMath, AccuracyBudget) {
+  // well-conditioned expressions, near poles any rewrite of the argument
+  // changes the result unboundedly
+  const char *corpus[] = {"sin(x)",
+                          "cos(x)",
+                          "ln(x)",
+                          "sin(x)/3 + cos(x)/7",
+                          "x/10 + 1 + sin(x) + 2",
+                          "ln(x^2 + 1)",
+                          "sin(x)*cos(x)",
+                          "sin(2x) + cos(3x) - 1",
+                          "x^3/6 - x/2 + 4",
+                          "sqrt(x^2 + 4)/5",
+                          "sin(x)^2 + cos(x)^2",
+                          "sin(cos(x))",
+                          "cos(x/4) * ln(x + 11)",
+                          "atan(x)/2 + ln(2 + sin(x))",
+                          "x*sin(1/x)",
+                          "(x + 3)/4 - (x - 5)/8",
+                          "sin(x) + sin(x + 1) + sin(x + 2)",
+                          "cos(sqrt(x^2 + 1))",
+                          "ln(x + 10)/ln(10)"};
+  s21::CalcModel exact, fast;
+  fast.setFastMathEnabled(true);
+  EXPECT_TRUE(fast.isFastMathEnabled());
+  double total = 0;
+  size_t points = 0;
+  for (const char *expression : corpus) {
+    exact.graphCalculate(expression, 0.001, 10, -10, 1e300, -1e300);
+    fast.graphCalculate(expression, 0.001, 10, -10, 1e300, -1e300);
+    std::vector<double> expected = exact.getGraph().second;
+    std::vector<double> ys = fast.getGraph().second;
+    ASSERT_EQ(expected.size(), ys.size());
+    double worst = 0;
+    for (size_t i = 0; i < ys.size(); ++i) {
+      if (!std::isnan(expected[i])) {
+        double error = scaledUlpError(ys[i], expected[i]);
+        worst = std::max(worst, error);
+        total += error;
+        ++points;
+      }
+    }
+    EXPECT_LE(worst, 64) << expression;
+  }
+  EXPECT_LE(total / points, 8);
+  // both modes are cached separately
+  EXPECT_EQ(2 * std::size(corpus), exact.getCache().getMisses() +
+                                       fast.getCache().getMisses());
+  // seeded random corpus: nested arguments like sin(u) with |u| ~ 50 scale
+  // the error of u by the derivative, hence the wider max
+  std::mt19937 random(21);
+  double worst = 0;
+  total = 0;
+  points = 0;
+  for (int k = 0; k < 300; ++k) {
+    std::string expression = randomExpression(random, 4);
+    exact.graphCalculate(expression, 0.01, 10, -10, 1e300, -1e300);
+    fast.graphCalculate(expression, 0.01, 10, -10, 1e300, -1e300);
+    std::vector<double> expected = exact.getGraph().second;
+    std::vector<double> ys = fast.getGraph().second;
+    ASSERT_EQ(expected.size(), ys.size()) << expression;
+    for (size_t i = 0; i < ys.size(); ++i) {
+      if (!std::isnan(expected[i])) {
+        double error = scaledUlpError(ys[i], expected[i]);
+        worst = std::max(worst, error);
+        total += error;
+        ++points;
+      }
+    }
+  }
+  EXPECT_LE(worst, 4096);
+  EXPECT_LE(total / points, 8);
+}
+
+TEST(FastMath, Rewrites) {
+  s21::CalcModel model;
+  model.setFastMathEnabled(true);
+  model.modelCalculate("x/4 + 1 + sin(x) + 2", 2);
+  EXPECT_NEAR(0.5 + 3 + sin(2), model.getResult(), 1e-14);
+  // division, constant terms and sin
+  EXPECT_EQ(3u, model.getOptimizerReport().relaxed);
+  model.modelCalculate("5 - cos(x)", 1);
+  EXPECT_NEAR(5 - cos(1), model.getResult(), 1e-14);
+  // fast sin and cos still share one reduction
+  model.modelCalculate("sin(x) * cos(x)", 0.5);
+  EXPECT_NEAR(sin(0.5) * cos(0.5), model.getResult(), 1e-14);
+  EXPECT_EQ(1u, model.getOptimizerReport().fusedInstructions);
+  model.setFastMathEnabled(false);
+  model.modelCalculate("x/4 + 1 + sin(x) + 2", 2);
+  EXPECT_EQ(0u, model.getOptimizerReport().relaxed);
+  // x / 3 is not exact as x * (1 / 3)
+  s21::Program::Builder builder;
+  builder.pushOperation(s21::OpCode::kPushX);
+  builder.pushConstant(3);
+  builder.pushOperation(s21::OpCode::kDiv);
+  builder.pushOperation(s21::OpCode::kLn);
+  builder.pushConstant(0);
+  builder.pushOperation(s21::OpCode::kDiv);
+  s21::Program relaxed = s21::Optimizer::relaxPrecision(builder.build());
+  ASSERT_EQ(6u, relaxed.getSize());
+  EXPECT_EQ(s21::OpCode::kMul, relaxed.getCode()[2].code);
+  // the vector ln polynomial saved 7% for 2 ulp, ln stays exact
+  EXPECT_EQ(s21::OpCode::kLn, relaxed.getCode()[3].code);
+  EXPECT_EQ(s21::OpCode::kDiv, relaxed.getCode()[5].code);
+}
+
+TEST(IntervalMath, Bounds) {
+  using s21::Interval;
+  using s21::IntervalMath;
+  using s21::OpCode;
+  Interval sine = IntervalMath::applyUnary(OpCode::kSin, {0.5, 3});
+  EXPECT_NEAR(sin(3), sine.lo, 1e-9);
+  EXPECT_NEAR(1, sine.hi, 1e-9);
+  EXPECT_FALSE(sine.discontinuous);
+  Interval tangent = IntervalMath::applyUnary(OpCode::kTan, {1, 2});
+  EXPECT_TRUE(tangent.discontinuous);
+  EXPECT_EQ(-INFINITY, tangent.lo);
+  EXPECT_FALSE(IntervalMath::applyUnary(OpCode::kTan, {-1, 1}).discontinuous);
+  Interval root = IntervalMath::applyUnary(OpCode::kSqrt, {-4, 9});
+  EXPECT_NEAR(0, root.lo, 1e-300);
+  EXPECT_NEAR(3, root.hi, 1e-15);
+  EXPECT_TRUE(IntervalMath::applyUnary(OpCode::kLn, {-2, -1}).isEmpty());
+  EXPECT_TRUE(IntervalMath::applyUnary(OpCode::kAsin, {1.5, 2}).isEmpty());
+  EXPECT_TRUE(IntervalMath::applyUnary(OpCode::kFactorial, {-2.5, -1.5})
+                  .discontinuous);
+  EXPECT_TRUE(IntervalMath::applyBinary(OpCode::kDiv, {1, 2}, {-1, 1})
+                  .discontinuous);
+  Interval square = IntervalMath::applyBinary(OpCode::kPow, {-3, 2}, {2, 2});
+  EXPECT_NEAR(0, square.lo, 1e-9);
+  EXPECT_NEAR(9, square.hi, 1e-9);
+  Interval mod = IntervalMath::applyBinary(OpCode::kMod, {4.2, 4.8}, {2, 2});
+  EXPECT_FALSE(mod.discontinuous);
+  EXPECT_NEAR(0.2, mod.lo, 1e-15);
+  EXPECT_TRUE(IntervalMath::applyBinary(OpCode::kMod, {3.5, 4.5}, {2, 2})
+                  .discontinuous);
+  EXPECT_TRUE(
+      IntervalMath::applyBinary(OpCode::kAdd, Interval::empty(), {1, 2})
+          .isEmpty());
+}
+
+TEST(IntervalMath, Enclosure) {
+  // (x mod 3)! / sin(x) + sqrt(x) ^ 2.5 * cos(x) + tan(x) - ln(x) / 3
+  s21::Program::Builder builder;
+  builder.pushOperation(s21::OpCode::kPushX);
+  builder.pushConstant(3);
+  builder.pushOperation(s21::OpCode::kMod);
+  builder.pushOperation(s21::OpCode::kFactorial);
+  builder.pushOperation(s21::OpCode::kPushX);
+  builder.pushOperation(s21::OpCode::kSin);
+  builder.pushOperation(s21::OpCode::kDiv);
+  builder.pushOperation(s21::OpCode::kPushX);
+  builder.pushOperation(s21::OpCode::kSqrt);
+  builder.pushConstant(2.5);
+  builder.pushOperation(s21::OpCode::kPow);
+  builder.pushOperation(s21::OpCode::kPushX);
+  builder.pushOperation(s21::OpCode::kCos);
+  builder.pushOperation(s21::OpCode::kMul);
+  builder.pushOperation(s21::OpCode::kAdd);
+  builder.pushOperation(s21::OpCode::kPushX);
+  builder.pushOperation(s21::OpCode::kTan);
+  builder.pushOperation(s21::OpCode::kAdd);
+  builder.pushOperation(s21::OpCode::kPushX);
+  builder.pushOperation(s21::OpCode::kLn);
+  builder.pushConstant(3);
+  builder.pushOperation(s21::OpCode::kDiv);
+  builder.pushOperation(s21::OpCode::kSub);
+  s21::Program source = builder.build();
+  std::mt19937_64 random(15);
+  std::uniform_real_distribution<double> center(-2, 12);
+  std::uniform_real_distribution<double> unit(0, 1);
+  for (auto mode : {s21::Optimizer::Mode::kExact, s21::Optimizer::Mode::kFast}) {
+    s21::Program program = s21::Optimizer::optimize(source, nullptr, mode);
+    std::vector<s21::Interval> intervals(program.getScratchSize());
+    std::vector<double> stack(program.getScratchSize());
+    std::vector<double> xs(64), ys(64);
+    size_t bounded = 0;
+    for (int i = 0; i < 2000; ++i) {
+      double lo = center(random);
+      double width = std::pow(10, -6 * unit(random));
+      for (size_t j = 0; j < xs.size(); ++j) {
+        xs[j] = lo + width * j / (xs.size() - 1);
+      }
+      s21::Interval y =
+          s21::IntervalMath::evaluate(program, {xs.front(), xs.back()},
+                                      intervals.data());
+      bounded += std::isfinite(y.lo) && std::isfinite(y.hi);
+      program.evaluate(xs, ys);
+      for (size_t j = 0; j < xs.size(); ++j) {
+        double value = program.evaluate(xs[j], stack.data());
+        for (double result : {ys[j], value}) {
+          if (!std::isnan(result)) {
+            EXPECT_TRUE(y.lo <= result && result <= y.hi)
+                << xs[j] << ": " << result << " not in [" << y.lo << ", "
+                << y.hi << "]";
+          }
+        }
+      }
+    }
+    // most ranges avoid poles and get finite bounds
+    EXPECT_GT(bounded, 1000u);
+  }
+}
+
+TEST(Graph, IntervalSampling) {
+  const char *corpus[] = {"tan(x)", "1/x", "x^2 - 3*x + sin(x)/(x - 1)",
+                          "ln(x) * 10", "x mod 2.5", "(x - 3)!",
+                          "sin(x)/x", "x/x"};
+  s21::CalcModel sampled, plain;
+  // off by default, it costs more than it skips
+  EXPECT_FALSE(plain.isIntervalSamplingEnabled());
+  sampled.setIntervalSamplingEnabled(true);
+  EXPECT_TRUE(sampled.isIntervalSamplingEnabled());
+  for (bool jit : {false, true}) {
+    sampled.setJitEnabled(jit);
+    plain.setJitEnabled(jit);
+    for (const char *expression : corpus) {
+      for (double window : {2.0, 1e300}) {
+        sampled.graphCalculate(expression, 0.001, 10, -10, window, -window);
+        plain.graphCalculate(expression, 0.001, 10, -10, window, -window);
+        s21::CalcModel::GraphXY expected = plain.getGraph();
+        s21::CalcModel::GraphXY graph = sampled.getGraph();
+        // same points apart from the inserted breaks
+        size_t breaks = 0;
+        for (size_t i = 0, j = 0; i < expected.first.size(); ++i, ++j) {
+          while (j < graph.first.size() &&
+                 graph.first[j] != expected.first[i]) {
+            EXPECT_TRUE(std::isnan(graph.second[j]));
+            ++breaks;
+            ++j;
+          }
+          ASSERT_LT(j, graph.first.size()) << expression;
+          double y = expected.second[i];
+          EXPECT_TRUE(y == graph.second[j] ||
+                      (std::isnan(y) && std::isnan(graph.second[j])))
+              << expression << " at " << expected.first[i];
+        }
+        EXPECT_EQ(expected.first.size() + breaks, graph.first.size());
+        if (std::string(expression) == "tan(x)") {
+          // poles at +-pi/2, +-3pi/2, +-5pi/2
+          EXPECT_EQ(window > 2 ? 6u : 0u, breaks);
+        } else if (std::string(expression) == "1/x") {
+          EXPECT_EQ(window > 2 ? 1u : 0u, breaks);
+        } else if (std::string(expression) == "sin(x)/x" ||
+                   std::string(expression) == "x/x") {
+          // removable singularities at 0
+          EXPECT_EQ(0u, breaks) << expression;
+        }
+      }
+    }
+  }
+}
+
+TEST(DualMath, Derivatives) {
+  s21::CalcModel model;
+  struct Case {
+    const char *expression;
+    double x;
+    double derivative;
+  } cases[] = {
+      {"x^3 - 2x", 2, 10},
+      {"sin(x) * cos(x)", 0.3, cos(0.6)},
+      {"tan(x)", 1, 1 / (cos(1) * cos(1))},
+      {"acos(x) + asin(x)", 0.4, 0},
+      {"atan(x)", 2, 0.2},
+      {"ln(x) + log(x)", 4, 0.25 + 1 / (4 * log(10))},
+      {"sqrt(x)", 9, 1.0 / 6},
+      {"x!", 2.5, tgamma(3.5) * 1.1031566406452432},
+      {"x mod 3", 7.5, 1},
+      {"10 mod x", 4, -2},
+      {"2^x", 3, 8 * log(2)},
+      {"x^x", 2, 4 * (log(2) + 1)},
+      {"(-x)^3", 2, -12},
+      {"x%", 50, 0.01},
+      {"1/x", 4, -1.0 / 16},
+      {"-x + 5", 1, -1},
+  };
+  for (const Case &test : cases) {
+    model.modelDifferentiate(test.expression, test.x);
+    EXPECT_NEAR(test.derivative, model.getDerivative(), 1e-12)
+        << test.expression;
+    model.modelCalculate(test.expression, test.x, s21::Precision::kDouble);
+    double value = model.getResult();
+    model.modelDifferentiate(test.expression, test.x);
+    EXPECT_EQ(value, model.getResult()) << test.expression;
+  }
+  EXPECT_NEAR(-0.57721566490153286, s21::DualMath::digamma(1), 4e-15);
+  EXPECT_NEAR(0.03648997397857652, s21::DualMath::digamma(-0.5), 1e-14);
+  EXPECT_NEAR(4.6001618527380874, s21::DualMath::digamma(100), 1e-14);
+  EXPECT_TRUE(std::isnan(s21::DualMath::digamma(-2)));
+}
+
+TEST(DualMath, FiniteDifferences) {
+  // superinstructions and fast math codes differentiate like the exact ones
+  const char *corpus[] = {"3x^4 - 2x^3 + x - 7",
+                          "sin(x) * cos(x) * x + 3",
+                          "ln(x + 11) / (1 + x^2)",
+                          "x * sin(x) + x / 3 - x",
+                          "(x/2)! + 2^sin(x)",
+                          "sqrt(x^2 + 1) * atan(x) mod 2"};
+  for (bool fast : {false, true}) {
+    s21::CalcModel model;
+    model.setFastMathEnabled(fast);
+    for (const char *expression : corpus) {
+      for (double x = -4.95; x < 5; x += 0.1) {
+        const double h = 1e-6;
+        model.modelCalculate(expression, x + h, s21::Precision::kDouble);
+        double right = model.getResult();
+        model.modelCalculate(expression, x - h, s21::Precision::kDouble);
+        double left = model.getResult();
+        model.modelDifferentiate(expression, x);
+        double difference = (right - left) / (2 * h);
+        if (std::isfinite(difference) && std::abs(difference) < 1e3) {
+          EXPECT_NEAR(difference, model.getDerivative(),
+                      1e-5 * std::max(1.0, std::abs(difference)))
+              << expression << " at " << x;
+        }
+      }
+    }
+  }
+}
+
+TEST(RootFinder, Polynomial) {
+  using Kind = s21::CriticalPoint::Kind;
+  s21::CalcModel model;
+  // roots 0 and +-sqrt(3), maximum at -1, minimum at 1
+  model.criticalPointsCalculate("x^3 - 3x", 0.03, 5, -5);
+  std::vector<s21::CriticalPoint> points = model.getCriticalPoints();
+  ASSERT_EQ(5u, points.size());
+  const Kind kinds[] = {Kind::kRoot, Kind::kMaximum, Kind::kRoot,
+                        Kind::kMinimum, Kind::kRoot};
+  const double xs[] = {-std::sqrt(3), -1, 0, 1, std::sqrt(3)};
+  const double ys[] = {0, 2, 0, -2, 0};
+  for (size_t i = 0; i < points.size(); ++i) {
+    EXPECT_EQ(kinds[i], points[i].kind);
+    EXPECT_NEAR(xs[i], points[i].x, 1e-7);
+    EXPECT_NEAR(ys[i], points[i].y, 1e-14);
+  }
+  EXPECT_NEAR(std::sqrt(3), points[4].x, 1e-15);
+}
+
+TEST(RootFinder, ManyRoots) {
+  s21::CalcModel single, multi;
+  single.setThreadCount(1);
+  multi.setThreadCount(7);
+  single.criticalPointsCalculate("sin(1000x)", 0.0005, 10, -10);
+  multi.criticalPointsCalculate("sin(1000x)", 0.0005, 10, -10);
+  std::vector<s21::CriticalPoint> points = multi.getCriticalPoints();
+  std::vector<s21::CriticalPoint> expected = single.getCriticalPoints();
+  // roots at k pi / 1000, extrema halfway in between: k pi / 2000 for k from
+  // -6366 to 6365, the grid ends at 9.9995
+  ASSERT_EQ(12732u, points.size());
+  ASSERT_EQ(expected.size(), points.size());
+  for (size_t i = 0; i < points.size(); ++i) {
+    EXPECT_EQ(expected[i].x, points[i].x);
+    double k = std::round(points[i].x * 2000 / M_PI);
+    EXPECT_NEAR(k * M_PI / 2000, points[i].x, 1e-13);
+    if (static_cast<long>(k) % 2 == 0) {
+      EXPECT_EQ(s21::CriticalPoint::Kind::kRoot, points[i].kind);
+      // 1000 * ulp(10) is the best possible near x = 10
+      EXPECT_NEAR(0, points[i].y, 1e-11);
+    } else {
+      EXPECT_NE(s21::CriticalPoint::Kind::kRoot, points[i].kind);
+      EXPECT_NEAR(1, std::abs(points[i].y), 1e-12);
+    }
+  }
+}
+
+TEST(RootFinder, Poles) {
+  s21::CalcModel model;
+  // sign changes at the poles, no roots or extrema
+  model.criticalPointsCalculate("1/x", 0.01, 5, -5);
+  EXPECT_TRUE(model.getCriticalPoints().empty());
+  model.criticalPointsCalculate("1/x^2", 0.01, 5, -5);
+  EXPECT_TRUE(model.getCriticalPoints().empty());
+  // no roots at the jumps 2 and 4, negative x mod 2 - 1 is below -1
+  model.criticalPointsCalculate("x mod 2 - 1", 0.01, 5, -5);
+  std::vector<s21::CriticalPoint> points = model.getCriticalPoints();
+  ASSERT_EQ(2u, points.size());
+  EXPECT_NEAR(1, points[0].x, 1e-12);
+  EXPECT_NEAR(3, points[1].x, 1e-12);
+  // roots of tan at k pi only
+  model.criticalPointsCalculate("tan(x)", 0.01, 5, -5);
+  points = model.getCriticalPoints();
+  ASSERT_EQ(3u, points.size());
+  for (size_t i = 0; i < points.size(); ++i) {
+    EXPECT_NEAR((static_cast<double>(i) - 1) * M_PI, points[i].x, 1e-14);
+  }
+}
+
+TEST(Quadrature, Rule) {
+  // the Kronrod rule is exact up to degree 22, the Gauss rule up to 13
+  double xs[s21::Quadrature::kNodes], ys[s21::Quadrature::kNodes];
+  s21::Quadrature::nodes(0, 2, xs);
+  for (size_t i = 0; i < s21::Quadrature::kNodes; ++i) {
+    EXPECT_GT(xs[i], 0);
+    EXPECT_LT(xs[i], 2);
+    ys[i] = std::pow(xs[i], 13);
+  }
+  s21::Quadrature::Segment segment = s21::Quadrature::rule(0, 2, ys);
+  EXPECT_NEAR(std::pow(2, 14) / 14, segment.value, 1e-11);
+  // only the rounding error is left
+  EXPECT_LT(segment.error, 1e-13 * segment.absValue);
+  for (size_t i = 0; i < s21::Quadrature::kNodes; ++i) {
+    ys[i] = std::pow(xs[i], 20);
+  }
+  segment = s21::Quadrature::rule(0, 2, ys);
+  EXPECT_NEAR(std::pow(2, 21) / 21, segment.value, 1e-8);
+  EXPECT_GT(segment.error, 1);
+}
+
+TEST(Integral, Accuracy) {
+  s21::CalcModel model;
+  struct Case {
+    const char *expression;
+    double a, b, exact;
+  } cases[] = {
+      {"sin(x)", 0, 1000, 1 - std::cos(1000.0)},
+      {"ln(x)", 1, 10, 10 * std::log(10.0) - 9},
+      {"sqrt(x)", 0, 1, 2.0 / 3},
+      {"1 / sqrt(x)", 0, 1, 2},
+      {"x^2 - 3x", 3, -1, -(9 - 27.0 / 2 - (-1.0 / 3 - 3.0 / 2))},
+      {"sin(x)", -5, 5, 0},
+  };
+  for (const Case &c : cases) {
+    model.integralCalculate(c.expression, c.a, c.b);
+    s21::Integral integral = model.getIntegral();
+    EXPECT_TRUE(integral.converged) << c.expression;
+    EXPECT_NEAR(c.exact, integral.value, 1e-8) << c.expression;
+    EXPECT_LE(std::abs(c.exact - integral.value),
+              std::max(integral.error, 1e-15))
+        << c.expression;
+    EXPECT_LE(integral.evaluations, s21::CalcModel::kIntegralMaxEvaluations);
+  }
+}
+
+TEST(Integral, Budget) {
+  s21::CalcModel single, multi;
+  single.setThreadCount(1);
+  multi.setThreadCount(7);
+  // the pole is not integrable, the budget runs out
+  single.integralCalculate("1/x", -1, 2, 1e-10, 10000);
+  s21::Integral integral = single.getIntegral();
+  EXPECT_FALSE(integral.converged);
+  EXPECT_LE(integral.evaluations, 10000u);
+  EXPECT_GT(integral.evaluations, 9000u);
+  // many segments in parallel, the same result on any number of threads
+  single.integralCalculate("sin(100x) * x", 0, 1000);
+  multi.integralCalculate("sin(100x) * x", 0, 1000);
+  integral = multi.getIntegral();
+  EXPECT_TRUE(integral.converged);
+  EXPECT_EQ(single.getIntegral().value, integral.value);
+  EXPECT_EQ(single.getIntegral().evaluations, integral.evaluations);
+  double exact = (std::sin(1e5) - 1e5 * std::cos(1e5)) / 1e4;
+  EXPECT_NEAR(exact, integral.value, 1e-6);
+}
+
+TEST(Jit, MatchesInterpreter) {
+  // -(x mod 3) ^ 2.5 + sin(x) * 2.5 / x% - sin(x) + ln(x)
+  s21::Program::Builder builder;
+  builder.pushOperation(s21::OpCode::kPushX);
+  builder.pushConstant(3);
+  builder.pushOperation(s21::OpCode::kMod);
+  builder.pushConstant(2.5);
+  builder.pushOperation(s21::OpCode::kPow);
+  builder.pushOperation(s21::OpCode::kNegate);
+  builder.pushOperation(s21::OpCode::kPushX);
+  builder.pushOperation(s21::OpCode::kSin);
+  builder.pushConstant(2.5);
+  builder.pushOperation(s21::OpCode::kMul);
+  builder.pushOperation(s21::OpCode::kPushX);
+  builder.pushOperation(s21::OpCode::kPercent);
+  builder.pushOperation(s21::OpCode::kDiv);
+  builder.pushOperation(s21::OpCode::kAdd);
+  builder.pushOperation(s21::OpCode::kPushX);
+  builder.pushOperation(s21::OpCode::kSin);
+  builder.pushOperation(s21::OpCode::kSub);
+  builder.pushOperation(s21::OpCode::kPushX);
+  builder.pushOperation(s21::OpCode::kLn);
+  builder.pushOperation(s21::OpCode::kAdd);
+  s21::Program program = s21::Optimizer::optimize(builder.build());
+  ASSERT_EQ(1u, program.getTemporaryCount());
+  s21::JitProgram jit(program);
+  EXPECT_EQ(s21::JitProgram::isSupported(), jit.isCompiled());
+  std::vector<double> xs(1001), ys(1001), expected(1001);
+  std::vector<double> stack(program.getScratchSize());
+  for (size_t i = 0; i < xs.size(); ++i) {
+    xs[i] = -20.0 + 0.04 * i;
+  }
+  xs[7] = NAN;
+  xs[8] = INFINITY;
+  program.evaluate(xs, expected);
+  jit.evaluate(xs, ys);
+  for (size_t i = 0; i < xs.size(); ++i) {
+    double value = program.evaluate(xs[i], stack.data());
+    double result = jit.evaluate(xs[i], stack.data());
+    EXPECT_TRUE(value == result || (std::isnan(value) && std::isnan(result)));
+    EXPECT_TRUE(expected[i] == ys[i] ||
+                (std::isnan(expected[i]) && std::isnan(ys[i])));
+  }
+}
+
+TEST(Jit, Graph) {
+  s21::CalcModel model;
+  const std::string expression = "x^2 - 3*x + sin(x)*cos(x) / (1 + x^2)";
+  model.graphCalculate(expression, 0.01, 10, -10, 100, -100);
+  s21::CalcModel::GraphXY expected = model.getGraph();
+  model.setJitEnabled(true);
+  EXPECT_TRUE(model.isJitEnabled());
+  model.graphCalculate(expression, 0.01, 10, -10, 100, -100);
+  s21::CalcModel::GraphXY graph = model.getGraph();
+  ASSERT_EQ(expected.second.size(), graph.second.size());
+  EXPECT_EQ(0, std::memcmp(expected.second.data(), graph.second.data(),
+                           graph.second.size() * sizeof(double)));
+}
+
+TEST(Graph, Graph1) {
+  s21::CalcModel model;
+  model.graphCalculate("x^2 + sin(x)", 0.5, 5, -5, 100, -100);
+  s21::CalcModel::GraphXY graph = model.getGraph();
+  ASSERT_EQ(20u, graph.first.size());
+  ASSERT_EQ(20u, graph.second.size());
+  for (size_t i = 0; i < graph.first.size(); ++i) {
+    double x = graph.first[i];
+    double y = x * x + sin(x);
+    if (std::isnormal(y)) {
+      EXPECT_DOUBLE_EQ(y, graph.second[i]);
+    }
+  }
+}
+
+TEST(Graph, Take) {
+  s21::CalcModel model;
+  model.graphCalculate("x^2", 0.001, 5, -5, 100, -100);
+  s21::CalcModel::GraphXY expected = model.getGraph();
+  s21::CalcModel::GraphXY graph = model.takeGraph();
+  EXPECT_EQ(10000u, graph.first.size());
+  EXPECT_EQ(expected.first, graph.first);
+  EXPECT_TRUE(std::is_sorted(graph.first.begin(), graph.first.end()));
+  EXPECT_TRUE(model.getGraph().first.empty());
+  EXPECT_TRUE(model.takeGraph().second.empty());
+}
+
+TEST(Graph, Deterministic) {
+  s21::CalcModel single, multi;
+  single.setThreadCount(1);
+  multi.setThreadCount(7);
+  single.setIntervalSamplingEnabled(true);
+  multi.setIntervalSamplingEnabled(true);
+  const std::string expression = "sin(x)/x + ln(x)*x mod 3 + sqrt(x)";
+  single.graphCalculate(expression, 0.0001, 50, -50, 100, -100);
+  multi.graphCalculate(expression, 0.0001, 50, -50, 100, -100);
+  s21::CalcModel::GraphXY expected = single.getGraph();
+  s21::CalcModel::GraphXY graph = multi.getGraph();
+  // the grid and breaks at the jumps of mod
+  ASSERT_EQ(expected.second.size(), graph.second.size());
+  EXPECT_LT(1000000u, graph.second.size());
+  EXPECT_EQ(expected.first, graph.first);
+  EXPECT_EQ(0, std::memcmp(expected.second.data(), graph.second.data(),
+                           graph.second.size() * sizeof(double)));
+}
+
+TEST(Graph, Adaptive) {
+  s21::CalcModel model;
+  // a flat curve with a narrow peak, drawn within tolerance everywhere
+  const double tolerance = 1e-3;
+  model.graphCalculateAdaptive("1/(1 + 10000x^2) + sin(x)/10", 10, -10, 2, -2,
+                               4096, tolerance);
+  s21::CalcModel::GraphXY graph = model.getGraph();
+  ASSERT_LT(graph.first.size(), 4096u);
+  EXPECT_TRUE(std::is_sorted(graph.first.begin(), graph.first.end()));
+  auto f = [](double x) { return 1 / (1 + 10000 * x * x) + sin(x) / 10; };
+  for (size_t i = 0; i < graph.first.size(); ++i) {
+    EXPECT_DOUBLE_EQ(f(graph.first[i]), graph.second[i]);
+  }
+  double worst = 0;
+  for (size_t i = 0; i + 1 < graph.first.size(); ++i) {
+    double x0 = graph.first[i], x1 = graph.first[i + 1];
+    for (int k = 1; k < 16; ++k) {
+      double x = x0 + (x1 - x0) * k / 16;
+      double line = graph.second[i] +
+                    (graph.second[i + 1] - graph.second[i]) * k / 16;
+      worst = std::max(worst, std::abs(f(x) - line) / 4);
+    }
+  }
+  // the test at midpoints sees the curve, not its max between samples
+  EXPECT_LT(worst, 4 * tolerance);
+  // a uniform grid that fine would take 20 / 0.0025 points
+  model.graphCalculate("1/(1 + 10000x^2) + sin(x)/10", 0.0025, 10, -10, 2, -2);
+  EXPECT_LT(10 * graph.first.size(), model.getGraph().first.size());
+  // the budget stops refinement, poles break the line
+  model.graphCalculateAdaptive("tan(x) + 10", 10, -10, 1e6, -1e6, 1000);
+  graph = model.getGraph();
+  size_t breaks = 0;
+  for (size_t i = 1; i + 1 < graph.second.size(); ++i) {
+    breaks += std::isnan(graph.second[i]);
+  }
+  EXPECT_EQ(6u, breaks);
+  EXPECT_GE(1006u, graph.first.size());
+  // removable singularities do not, 0 / 0 is NaN at the sample x = 0 only
+  for (const char *expression : {"sin(x)/x", "x/x"}) {
+    model.graphCalculateAdaptive(expression, 10, -10, 2, -2, 1000);
+    graph = model.getGraph();
+    for (size_t i = 0; i < graph.second.size(); ++i) {
+      EXPECT_TRUE(!std::isnan(graph.second[i]) || graph.first[i] == 0)
+          << expression << " at " << graph.first[i];
+    }
+  }
+  model.graphCalculateAdaptive("x", 1, 1, 10, -10);
+  EXPECT_EQ(1u, model.getGraph().first.size());
+  model.graphCalculateAdaptive("sqrt(x)", 1, -1, 10, -10, 0);
+  EXPECT_TRUE(model.getGraph().first.empty());
+}
+
+TEST(Graph, PixelColumns) {
+  s21::CalcModel model, dense;
+  const char *expression = "sin(50x) + x/5 + tan(x)/20";
+  const size_t width = 300, samples = 16;
+  model.graphCalculatePixels(expression, 10, -10, 1.5, -1.5, width, samples);
+  dense.graphCalculatePixels(expression, 10, -10, 1.5, -1.5, width * samples,
+                             1);
+  s21::CalcModel::GraphXY graph = model.getGraph();
+  s21::CalcModel::GraphXY expected = dense.getGraph();
+  EXPECT_TRUE(std::is_sorted(graph.first.begin(), graph.first.end()));
+  EXPECT_LT(graph.first.size(), expected.first.size() / 3);
+  // the same vertical extent in each column
+  auto extents = [&](const s21::CalcModel::GraphXY &points) {
+    std::vector<std::pair<double, double>> result(width, {INFINITY, -INFINITY});
+    for (size_t i = 0; i < points.first.size(); ++i) {
+      size_t column = std::min<size_t>((points.first[i] + 10) / 20 * width,
+                                       width - 1);
+      if (!std::isnan(points.second[i])) {
+        result[column].first = std::min(result[column].first, points.second[i]);
+        result[column].second =
+            std::max(result[column].second, points.second[i]);
+      }
+    }
+    return result;
+  };
+  EXPECT_EQ(extents(expected), extents(graph));
+  // breaks at the window edges and the poles of tan are kept
+  auto breaks = [](const s21::CalcModel::GraphXY &points) {
+    size_t count = 0;
+    for (size_t i = 1; i < points.second.size(); ++i) {
+      count += std::isnan(points.second[i]) && !std::isnan(points.second[i - 1]);
+    }
+    return count;
+  };
+  EXPECT_EQ(breaks(expected), breaks(graph));
+  EXPECT_LT(0u, breaks(graph));
+  model.graphCalculatePixels("x", 1, 1, 10, -10, width);
+  EXPECT_EQ(1u, model.getGraph().first.size());
+}
+
+TEST(Graph, Derivative) {
+  s21::CalcModel model;
+  model.setThreadCount(3);
+  model.graphCalculateDerivative("sin(x) * x", 0.001, 30, -30, 10, -10);
+  s21::CalcModel::GraphXY graph = model.getGraph();
+  ASSERT_EQ(60000u, graph.first.size());
+  for (size_t i = 0; i < graph.first.size(); ++i) {
+    double x = graph.first[i];
+    double y = cos(x) * x + sin(x);
+    if (std::isfinite(y) && std::abs(y) <= 10) {
+      EXPECT_NEAR(y, graph.second[i], 1e-12);
+    } else {
+      EXPECT_TRUE(std::isnan(graph.second[i]));
+    }
+  }
+  // zero slopes are plotted
+  model.graphCalculateDerivative("5", 0.5, 2, -2, 10, -10);
+  graph = model.getGraph();
+  ASSERT_EQ(8u, graph.second.size());
+  for (double y : graph.second) {
+    EXPECT_EQ(0.0, y);
+  }
+  model.graphCalculateDerivative("x^2", 1, 2, -2, 10, -10);
+  EXPECT_EQ((std::vector<double>{-4, -2, 0, 2}), model.getGraph().second);
+}
+
+TEST(Budget, Points) {
+  s21::CalcModel model;
+  s21::Budget budget;
+  budget.maxPoints = 5000;
+  model.setBudget(budget);
+  model.setThreadCount(3);
+  // x values are a prefix of the grid
+  model.graphCalculate("sin(x)", 0.001, 30, -30, 10, -10);
+  EXPECT_EQ(s21::JobStatus::kTruncated, model.getStatus());
+  s21::CalcModel::GraphXY graph = model.getGraph();
+  ASSERT_EQ(5000u, graph.first.size());
+  EXPECT_DOUBLE_EQ(-30, graph.first.front());
+  EXPECT_DOUBLE_EQ(std::sin(graph.first.back()), graph.second.back());
+  model.graphCalculate("sin(x)", 0.1, 30, -30, 10, -10);
+  EXPECT_EQ(s21::JobStatus::kComplete, model.getStatus());
+  EXPECT_EQ(600u, model.getGraph().first.size());
+  // columns are thinned, the whole range is drawn
+  model.graphCalculatePixels("sin(x)", 30, -30, 10, -10, 1000, 16);
+  EXPECT_EQ(s21::JobStatus::kTruncated, model.getStatus());
+  EXPECT_LT(29.9, model.getGraph().first.back());
+  model.graphCalculateAdaptive("sin(100x)", 30, -30, 1, -1, 10000, 1e-3);
+  EXPECT_EQ(s21::JobStatus::kTruncated, model.getStatus());
+  EXPECT_GE(5000u, model.getGraph().first.size());
+  model.integralCalculate("sin(100x)/x", 1, 1000, 1e-12);
+  EXPECT_EQ(s21::JobStatus::kTruncated, model.getStatus());
+  EXPECT_GE(5000u, model.getIntegral().evaluations);
+  model.integralCalculate("x^2", 0, 3);
+  EXPECT_EQ(s21::JobStatus::kComplete, model.getStatus());
+  EXPECT_NEAR(9, model.getIntegral().value, 1e-12);
+  // batch evaluation stops at the point budget
+  s21::CompiledExpression expression("sin(x)");
+  s21::CompiledExpression::Context context;
+  std::vector<double> xs(6000, 1), ys(6000, 0);
+  s21::BudgetMeter meter;
+  meter.start(budget);
+  EXPECT_EQ(5000u, expression.evaluate(xs, ys, context, meter));
+  EXPECT_EQ(s21::JobStatus::kTruncated, meter.getStatus());
+  EXPECT_DOUBLE_EQ(std::sin(1.0), ys[4999]);
+  EXPECT_EQ(0, ys[5000]);
+}
+
+TEST(Budget, Cancel) {
+  s21::CalcModel model;
+  s21::Budget budget;
+  s21::CancellationToken token = budget.token;
+  model.setBudget(budget);
+  token.cancel();
+  model.graphCalculate("x", 0.001, 30, -30, 10, -10);
+  EXPECT_EQ(s21::JobStatus::kTruncated, model.getStatus());
+  EXPECT_TRUE(model.getGraph().first.empty());
+  model.integralCalculate("x", 0, 1);
+  EXPECT_TRUE(std::isnan(model.getIntegral().value));
+  token.reset();
+  model.criticalPointsCalculate("sin(x)", 0.001, 10, -10);
+  EXPECT_EQ(s21::JobStatus::kComplete, model.getStatus());
+  EXPECT_EQ(13u, model.getCriticalPoints().size());
+  // from inside a chunk, the chunks after it are skipped
+  s21::BudgetMeter meter;
+  meter.start(budget);
+  std::size_t chunks = 0;
+  while (meter.proceed()) {
+    if (++chunks == 3) {
+      token.cancel();
+    }
+  }
+  EXPECT_EQ(3u, chunks);
+  EXPECT_EQ(s21::JobStatus::kTruncated, meter.getStatus());
+  token.reset();
+  EXPECT_FALSE(meter.proceed());
+  // batch evaluation
+  s21::CompiledExpression expression("sin(x)");
+  s21::CompiledExpression::Context context;
+  std::vector<double> xs(1000, 1), ys(1000, 0);
+  token.cancel();
+  meter.start(budget);
+  EXPECT_EQ(0u, expression.evaluate(xs, ys, context, meter));
+  EXPECT_EQ(s21::JobStatus::kTruncated, meter.getStatus());
+  EXPECT_EQ(std::vector<double>(1000, 0), ys);
+  token.reset();
+  meter.start(budget);
+  EXPECT_EQ(1000u, expression.evaluate(xs, ys, context, meter));
+  EXPECT_EQ(s21::JobStatus::kComplete, meter.getStatus());
+  EXPECT_EQ(std::vector<double>(1000, std::sin(1.0)), ys);
+}
+
+TEST(Budget, Time) {
+  s21::CalcModel model;
+  s21::Budget budget;
+  // an expired budget stops before the first chunk
+  budget.maxTime = s21::Budget::Clock::duration::zero();
+  model.setBudget(budget);
+  model.graphCalculate("sin(x) * cos(x)", 0.001, 5, -5, 10, -10);
+  EXPECT_EQ(s21::JobStatus::kTruncated, model.getStatus());
+  EXPECT_TRUE(model.getGraph().first.empty());
+  s21::CompiledExpression expression("sin(x) * cos(x)");
+  std::vector<double> xs(1000, 1), ys(1000, 0);
+  s21::BudgetMeter meter;
+  meter.start(budget);
+  EXPECT_EQ(0u, expression.getProgram().evaluate(xs, ys, meter));
+  EXPECT_EQ(s21::JobStatus::kTruncated, meter.getStatus());
+  // a budget the job cannot use up
+  budget.maxTime = std::chrono::hours(1);
+  model.setBudget(budget);
+  model.graphCalculate("sin(x) * cos(x)", 0.001, 5, -5, 10, -10);
+  EXPECT_EQ(s21::JobStatus::kComplete, model.getStatus());
+  EXPECT_EQ(10000u, model.getGraph().first.size());
+  meter.start(budget);
+  EXPECT_EQ(1000u, expression.getProgram().evaluate(xs, ys, meter));
+  EXPECT_EQ(s21::JobStatus::kComplete, meter.getStatus());
+}
+
+TEST(ThreadPool, ParallelFor) {
+  s21::ThreadPool pool(4);
+  EXPECT_EQ(4u, pool.getThreadCount());
+  for (int run = 0; run < 3; ++run) {
+    std::vector<int> visits(1000);
+    pool.parallelFor(visits.size(), [&](size_t i) { ++visits[i]; });
+    EXPECT_EQ(std::vector<int>(1000, 1), visits);
+  }
+  EXPECT_THROW(pool.parallelFor(10,
+                                [](size_t i) {
+                                  if (i == 5) throw std::logic_error("task");
+                                }),
+               std::logic_error);
+}
+
 int main(int argc, char **argv) {
   ::testing::InitGoogleTest(&argc, argv);
   return RUN_ALL_TESTS();
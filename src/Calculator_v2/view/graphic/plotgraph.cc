@@ -7,10 +7,17 @@ namespace s21 {
 PlotGraph::PlotGraph(QWidget* parent)
     : QDialog(parent), ui_(new Ui::PlotGraph) {
   ui_->setupUi(this);
+  connect(ui_->stop, &QPushButton::clicked, this, &PlotGraph::cancelRequested);
+  connect(this, &QDialog::finished, this, &PlotGraph::cancelRequested);
 }
 
 PlotGraph::~PlotGraph() { delete ui_; }
 
+/// @brief get width of the plot area, graphs need no more points per pixel
+/// column than the first, min, max and last one
+/// @return int pixels
+int PlotGraph::getPlotWidth() const { return ui_->widget->width(); }
+
 /// @brief The main function of the plot graph
 /// @param graph std::pair<QVector<double>, QVector<double>> x and y coordinates
 /// @param xMax
@@ -38,4 +45,54 @@ void PlotGraph::plotGraph(std::pair<QVector<double>, QVector<double>> graph,
   }
 }
 
+/// @brief mark points over the plotted graph, call after plotGraph()
+/// @param points std::pair<QVector<double>, QVector<double>> x and y
+/// coordinates
+/// @param color marker color
+void PlotGraph::markPoints(std::pair<QVector<double>, QVector<double>> points,
+                           QColor color) {
+  try {
+    ui_->widget->addGraph();
+    ui_->widget->graph()->setLineStyle(QCPGraph::lsNone);
+    ui_->widget->graph()->setScatterStyle(
+        QCPScatterStyle(QCPScatterStyle::ssCircle, color, color, 7));
+    ui_->widget->graph()->addData(points.first, points.second, true);
+
+    ui_->widget->replot();
+  } catch (std::exception& e) {
+    QMessageBox::critical(this, "Warning", e.what());
+  }
+}
+
+/// @brief replace the points of the graph, call after plotGraph()
+/// @param data points sorted by x, NaN breaks the line, shared with the
+/// graph without copying
+/// @param refined false for a coarse preview
+void PlotGraph::setGraphData(QSharedPointer<QCPGraphDataContainer> data,
+                             bool refined) {
+  int points = data->size();
+  ui_->widget->graph(0)->setData(std::move(data));
+  ui_->status->setText(refined ? tr("Calculated %1 points").arg(points)
+                               : tr("Preview, refining..."));
+  ui_->widget->replot();
+}
+
+/// @brief mark points over the graph, see markPoints()
+/// @param x x coordinates
+/// @param y y coordinates
+/// @param color marker color
+void PlotGraph::addPoints(QVector<double> x, QVector<double> y,
+                          QColor color) {
+  markPoints(std::make_pair(std::move(x), std::move(y)), color);
+}
+
+/// @brief show that the calculation is over
+/// @param truncated true if the graph is partial: stopped or out of budget
+void PlotGraph::setCalculated(bool truncated) {
+  ui_->stop->setEnabled(false);
+  if (truncated) {
+    ui_->status->setText(ui_->status->text() + tr(", stopped early"));
+  }
+}
+
 }  // namespace s21
@@ -20,8 +20,20 @@ class PlotGraph : public QDialog {
   explicit PlotGraph(QWidget *parent = nullptr);
   void plotGraph(std::pair<QVector<double>, QVector<double>> graph, double xMax,
                  double xMin, double yMax, double yMin);
+  void markPoints(std::pair<QVector<double>, QVector<double>> points,
+                  QColor color);
+  int getPlotWidth() const;
   ~PlotGraph();
 
+ public slots:
+  void setGraphData(QSharedPointer<QCPGraphDataContainer> data, bool refined);
+  void addPoints(QVector<double> x, QVector<double> y, QColor color);
+  void setCalculated(bool truncated);
+
+ signals:
+  //! the Stop button was clicked or the dialog was closed
+  void cancelRequested();
+
  private:
   Ui::PlotGraph *ui_;
 };
@@ -1,5 +1,6 @@
 #include "mainwindow.h"
 
+#include "controller/plotJob.h"
 #include "graphic/plotgraph.h"
 #include "ui_mainwindow.h"
 
@@ -45,6 +46,16 @@ double MainWindow::getYMax() const { return ui_->y_max->value(); }
 /// @brief get y min value
 /// @return double
 double MainWindow::getYMin() const { return ui_->y_min->value(); }
+/// @brief check if f'(x) is plotted instead of f(x)
+/// @return bool
+bool MainWindow::isDerivativePlotted() const {
+  return ui_->derivative->isChecked();
+}
+/// @brief check if roots and extrema are marked on the graph
+/// @return bool
+bool MainWindow::isCriticalPointsMarked() const {
+  return ui_->criticalPoints->isChecked();
+}
 /// @brief set calculated result
 /// @param result
 void MainWindow::setResultText(const double result) {
@@ -79,34 +90,33 @@ void MainWindow::on_btn_eq_clicked() {
   }
 }
 
-/// @brief plot graphic
+/// @brief plot graphic on a worker thread, see PlotJob: a preview comes
+/// first, the dialog stays responsive, Stop or closing it cancels the job
 void MainWindow::on_btn_plot_clicked() {
   inputText_ = ui_->input_text->displayText();
-  try {
-    Controller::GraphXY graphXY = controller_->getGraphFromModel(this);
-
-    QList<double> xList, yList;
-    xList.reserve(graphXY.first.size());
-    yList.reserve(graphXY.second.size());
-    std::copy(graphXY.first.begin(), graphXY.first.end(),
-              std::back_inserter(xList));
-    std::copy(graphXY.second.begin(), graphXY.second.end(),
-              std::back_inserter(yList));
-
-    std::pair<QVector<double>, QVector<double>> graph = std::make_pair(
-        QVector<double>::fromVector(xList), QVector<double>::fromVector(yList));
-    PlotGraph field;
-    field.plotGraph(graph, ui_->x_max->value(), ui_->x_min->value(),
-                    ui_->y_max->value(), ui_->y_min->value());
-    field.exec();
-
-    xList.clear();
-    yList.clear();
-    graph.first.clear();
-    graph.second.clear();
-  } catch (const std::exception &e) {
-    QMessageBox::critical(this, "Warning", e.what());
-  }
+  PlotGraph field;
+  field.plotGraph({}, ui_->x_max->value(), ui_->x_min->value(),
+                  ui_->y_max->value(), ui_->y_min->value());
+  // results arrive through queued connections while field.exec() runs
+  PlotJob job(controller_->getPlotRequest(this, field.getPlotWidth()),
+              controller_->getBudget());
+  connect(&job, &PlotJob::graphReady, &field, &PlotGraph::setGraphData,
+          Qt::QueuedConnection);
+  connect(&job, &PlotJob::pointsReady, &field, &PlotGraph::addPoints,
+          Qt::QueuedConnection);
+  connect(&job, &PlotJob::calculated, &field, &PlotGraph::setCalculated,
+          Qt::QueuedConnection);
+  connect(
+      &job, &PlotJob::failed, &field,
+      [this, &field](const QString &message) {
+        field.reject();
+        QMessageBox::critical(this, "Warning", message);
+      },
+      Qt::QueuedConnection);
+  connect(&field, &PlotGraph::cancelRequested, &job, &PlotJob::cancel,
+          Qt::DirectConnection);
+  job.start();
+  field.exec();
 }
 
 /*****************************************************************************
@@ -46,6 +46,8 @@ class MainWindow : public QMainWindow {
   double getXMin() const;
   double getYMax() const;
   double getYMin() const;
+  bool isDerivativePlotted() const;
+  bool isCriticalPointsMarked() const;
   // GETTERS FOR CREDIT
   double getCreditAmount() const;
   double getCreditTerm() const;